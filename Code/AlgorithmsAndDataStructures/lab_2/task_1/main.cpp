@@ -28,22 +28,27 @@ template
     typename Cmp = std::less<T>,
     typename Enable = std::enable_if_t<std::is_integral_v<T>>
 >
-void counting_sort(T* array, size_t size, T min, T max, Cmp cmp = Cmp{}) {
+void counting_sort(T* array, size_t size, T min, T max, std::vector<size_t>& counts, Cmp cmp = Cmp{}) {
     if (size < 2) {
         return;
     }
 
-    const T range = max - min + 1;
-    std::vector<size_t> counts(range);
+    // Unsigned arithmetic: difference of signed values may not fit in T
+    using U = std::make_unsigned_t<T>;
+    const size_t range = static_cast<size_t>(static_cast<U>(static_cast<U>(max) - static_cast<U>(min))) + 1;
 
-    for (T i = 0; i < size; ++i) {
-        ++counts[array[i] - min];
+    // 'counts' is kept between calls to avoid allocation on every sort
+    counts.assign(range, 0);
+
+    for (size_t i = 0; i < size; ++i) {
+        ++counts[static_cast<U>(static_cast<U>(array[i]) - static_cast<U>(min))];
     }
 
-    for (T i = min; i <= max; ++i) {
-        const size_t count = counts[i - min];
+    for (size_t offset = 0; offset < range; ++offset) {
+        const T value = static_cast<T>(static_cast<U>(static_cast<U>(min) + offset));
+        const size_t count = counts[offset];
         for(size_t j = 0; j < count; ++j) {
-            *array++ = i;
+            *array++ = value;
         }
     }
 }
@@ -78,11 +83,12 @@ int main() {
         bubble_sort(get_vector_data(array), array.size());
     };
 
+    std::vector<size_t> countingSortCounts;
     auto counting = [&](std::vector<T>& array) {
-        counting_sort(get_vector_data(array), array.size(), minValue, maxValue);
+        counting_sort(get_vector_data(array), array.size(), minValue, maxValue, countingSortCounts);
     };
 
-    auto get_process_duration = [](auto& f) {
+    auto get_process_duration = [](auto&& f) {
         auto t1 = Clock::now();
         f();
         auto t2 = Clock::now();
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Command line helpers shared by the lab 4 tools
+
+template<typename... Ts>
+struct type_list {};
+
+template<typename T>
+struct type_tag
+{
+    using type = T;
+};
+
+inline bool list_contains(const std::vector<std::string>& values, std::string_view value) {
+    return std::find(values.begin(), values.end(), value) != values.end();
+}
+
+// Splits comma separated list
+inline std::vector<std::string> split_list(std::string_view text) {
+    std::vector<std::string> result;
+    while (!text.empty()) {
+        const size_t comma = std::min(text.find(','), text.size());
+        if (comma != 0) {
+            result.emplace_back(text.substr(0, comma));
+        }
+        text.remove_prefix(std::min(comma + 1, text.size()));
+    }
+    return result;
+}
+
+// Parses number with optional decimal suffix: k, M or G
+inline bool parse_count(std::string_view text, uint64_t& out) {
+    uint64_t multiplier = 1;
+    if (!text.empty()) {
+        switch (text.back()) {
+        case 'k': case 'K': multiplier = 1000; break;
+        case 'm': case 'M': multiplier = 1000 * 1000; break;
+        case 'g': case 'G': multiplier = 1000 * 1000 * 1000; break;
+        default: break;
+        }
+        if (multiplier != 1) {
+            text.remove_suffix(1);
+        }
+    }
+
+    if (text.empty()) {
+        return false;
+    }
+
+    uint64_t value = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        value = value * 10 + static_cast<uint64_t>(c - '0');
+    }
+
+    out = value * multiplier;
+    return true;
+}
@@ -3,224 +3,234 @@
 // pyramid sort
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <chrono>
+#include <cstdint>
 #include <functional>
 #include <iomanip>
 #include <iostream>
-#include <memory>
 #include <fstream>
+#include <numeric>
 #include <random>
 #include <string>
 #include <string_view>
+#include <tuple>
+#include <type_traits>
 #include <vector>
-#include "sort/bubble_sort.h"
-#include "sort/counting_sort.h"
-#include "sort/quick_sort.h"
-#include "sort/merge_sort.h"
-#include "sort/heap_sort.h"
-#include "sort/radix_sort.h"
+#include "command_line.h"
+#include "sort_kernels.h"
+#include "sort/select.h"
+#include "sort/set_operations.h"
 
-template<typename T>
-T* get_vector_data(std::vector<T>& vec) {
-    return vec.empty() ? nullptr : &vec[0];
-}
+template<template<typename> typename... Predicates>
+struct predicate_list {};
 
-template<typename T, typename Predicate>
-class sort_functor
-{
-public:
-    virtual std::string_view get_name() const = 0;
-    virtual void update_cache(T* array, size_t size) = 0;
-    virtual void sort(T* array, size_t size) = 0;
-};
+using element_types = type_list<uint32_t, int32_t, uint64_t, float>;
+using sort_predicates = predicate_list<std::less, std::greater>;
 
-template<typename T, typename Predicate>
-class bubble_sort_functor :
-    public sort_functor<T, Predicate>
-{
-public:
-    virtual std::string_view get_name() const override final {
-        return "Bubble Sort";
+template<typename T>
+constexpr std::string_view type_id() {
+    if constexpr (std::is_same_v<T, uint32_t>) {
+        return "uint32";
     }
-
-    virtual void update_cache(T*, size_t) override final {
-
+    else if constexpr (std::is_same_v<T, int32_t>) {
+        return "int32";
     }
-
-    virtual void sort(T* array, size_t size) override final {
-        sort::bubble_sort<T, Predicate>(array, size);
+    else if constexpr (std::is_same_v<T, uint64_t>) {
+        return "uint64";
     }
-};
-
-template<typename T, typename Predicate>
-class counting_sort_functor :
-    public sort_functor<T, Predicate>
-{
-private:
-    using limits = std::numeric_limits<T>;
-public:
-    virtual std::string_view get_name() const override final {
-        return "Counting Sort";
+    else {
+        static_assert(std::is_same_v<T, float>);
+        return "float";
     }
+}
 
-    virtual void update_cache(T* array, size_t size) override final {
-        m_min = limits::max();
-        m_max = limits::lowest();
-        for (size_t i = 0; i < size; ++i) {
-            m_min = std::min(m_min, array[i]);
-            m_max = std::max(m_max, array[i]);
-        }
-        m_counts.resize(m_max - m_min + 1);
+template<template<typename> typename Predicate>
+constexpr std::string_view predicate_id() {
+    if constexpr (std::is_same_v<Predicate<int>, std::less<int>>) {
+        return "less";
     }
-
-    virtual void sort(T* array, size_t size) override final {
-        sort::counting_sort<T>(array, get_vector_data(m_counts), size, m_min, m_max);
+    else {
+        static_assert(std::is_same_v<Predicate<int>, std::greater<int>>);
+        return "greater";
     }
+}
 
-private:
-    T m_min = 0;
-    T m_max = 0;
-    std::vector<T> m_counts;
-};
-
-template<typename T, typename Predicate>
-class quick_sort_functor :
-    public sort_functor<T, Predicate>
+// Command line selection. Empty list means defaults
+struct benchmark_options
 {
-public:
-    virtual std::string_view get_name() const override final {
-        return "Quick Sort";
-    }
+    std::vector<std::string> types;
+    std::vector<std::string> predicates;
+    std::vector<std::string> kernels;
+    bool list = false;
 
-    virtual void update_cache(T*, size_t) override final {
+    bool type_selected(std::string_view id) const {
+        return types.empty() ? id == type_id<uint32_t>() : list_contains(types, id) || list_contains(types, "all");
+    }
 
+    bool predicate_selected(std::string_view id) const {
+        return predicates.empty() ? id == predicate_id<std::less>() : list_contains(predicates, id) || list_contains(predicates, "all");
     }
 
-    virtual void sort(T* array, size_t size) override final {
-        sort::quick_sort<T, Predicate>(array, size);
+    bool kernel_selected(std::string_view id) const {
+        return kernels.empty() || list_contains(kernels, id) || list_contains(kernels, "all");
     }
 };
 
-template<typename T, typename Predicate>
-class merge_sort_functor :
-    public sort_functor<T, Predicate>
+// Writes everything both to console and file
+class benchmark_log
 {
-private:
-    using limits = std::numeric_limits<T>;
 public:
-    virtual std::string_view get_name() const override final {
-        return "Merge Sort";
-    }
+    benchmark_log(std::ostream& log_stream, std::ostream& log_file) :
+        m_log_stream(log_stream),
+        m_log_file(log_file)
+    {}
 
-    virtual void update_cache(T* array, size_t size) override final {
-        m_cache.resize(size);
+    template<typename... Args>
+    void print(const Args&... args) {
+        (m_log_stream << ... << args);
+        (m_log_file << ... << args);
     }
 
-    virtual void sort(T* array, size_t size) override final {
-        sort::merge_sort<T, Predicate>(array, get_vector_data(m_cache), size);
+    template<typename... Args>
+    void println(const Args&... args) {
+        print(args..., '\n');
     }
 
 private:
-    std::vector<T> m_cache;
+    std::ostream& m_log_stream;
+    std::ostream& m_log_file;
 };
 
-template<typename T, typename Predicate>
-class heap_sort_functor :
-    public sort_functor<T, Predicate>
-{
-public:
-    virtual std::string_view get_name() const override final {
-        return "Heap Sort";
-    }
-
-    virtual void update_cache(T*, size_t) override final {
-
-    }
+// Calls 'fn' for every kernel of the tuple which supports its type and is selected
+template<typename Tuple, typename Fn>
+void for_each_kernel(Tuple& kernels, const benchmark_options& options, Fn&& fn) {
+    std::apply([&](auto&... kernel) {
+        auto visit = [&](auto& k) {
+            using kernel_t = std::decay_t<decltype(k)>;
+            if constexpr (kernel_t::supported) {
+                if (options.kernel_selected(kernel_t::id())) {
+                    fn(k);
+                }
+            }
+        };
+        (visit(kernel), ...);
+    }, kernels);
+}
 
-    virtual void sort(T* array, size_t size) override final {
-        sort::heap_sort<T, Predicate>(array, size);
-    }
-};
+// Finds auto sort decision points by timing the competing kernels on generated data
+template<typename T, typename Generator>
+sort::auto_sort_thresholds calibrate_auto_sort(Generator& gen, size_t size) {
+    using clock = std::chrono::high_resolution_clock;
+    constexpr size_t repeats = 5;
+
+    sort::scratch_arena arena;
+    std::vector<T> input;
+    std::vector<T> work;
+    std::vector<T> buffer(size);
+
+    // Median of several runs, each on a fresh copy of input
+    auto measure = [&](auto&& sort_fn) {
+        std::vector<clock::duration> times;
+        for (size_t i = 0; i < repeats; ++i) {
+            work = input;
+            const auto t1 = clock::now();
+            sort_fn(get_vector_data(work), work.size());
+            const auto t2 = clock::now();
+            times.push_back(t2 - t1);
+        }
+        std::nth_element(times.begin(), times.begin() + repeats / 2, times.end());
+        return times[repeats / 2];
+    };
 
-template<typename T, typename Predicate>
-class radix_sort_msd_functor :
-    public sort_functor<T, Predicate>
-{
-public:
-    virtual std::string_view get_name() const override final {
-        return "Radix Sort (MSD)";
-    }
+    auto intro = [](T* array, size_t n) {
+        sort::intro_sort(array, n);
+    };
 
-    virtual void update_cache(T*, size_t) override final {
+    auto radix = [&](T* array, size_t n) {
+        sort::integer_sort_options options;
+        options.range_factor = 0;
+        sort::integer_sort(array, n, arena, options);
+    };
 
-    }
+    auto counting = [&](T* array, size_t n) {
+        sort::integer_sort_options options;
+        options.range_factor = std::numeric_limits<size_t>::max();
+        sort::integer_sort(array, n, arena, options);
+    };
 
-    virtual void sort(T* array, size_t size) override final {
-        sort::radix_sort_msd<T>(array, size);
-    }
-};
+    auto natural_merge = [&](T* array, size_t n) {
+        sort::natural_merge_sort(array, get_vector_data(buffer), n);
+    };
 
-template<typename T, typename Predicate>
-class radix_sort_lsd_functor :
-    public sort_functor<T, Predicate>
-{
-public:
-    virtual std::string_view get_name() const override final {
-        return "Radix Sort (LSD)";
-    }
+    auto generate = [&](size_t n, T max) {
+        std::uniform_int_distribution<T> distribution(0, max);
+        input.resize(n);
+        std::generate(input.begin(), input.end(), [&]() {
+            return distribution(gen);
+        });
+    };
 
-    virtual void update_cache(T*, size_t size) override final {
-        m_buffer.resize(size);
-    }
+    sort::auto_sort_thresholds thresholds;
 
-    virtual void sort(T* array, size_t size) override final {
-        sort::radix_sort_lsd<T>(array, m_buffer.data(), size);
+    // The smallest size where radix sort beats intro sort
+    thresholds.radix_min_size = size;
+    for (size_t n = 256; n <= size; n *= 2) {
+        generate(n, std::numeric_limits<T>::max());
+        if (measure(radix) < measure(intro)) {
+            thresholds.radix_min_size = n;
+            break;
+        }
     }
 
-private:
-    std::vector<T> m_buffer;
-};
-
-template<typename T, typename Predicate>
-class sort_functor_adapter
-{
-public:
-    sort_functor_adapter(sort_functor<T, Predicate>& functor) :
-        m_functor(functor)
-    {}
-
-    std::string_view get_name() const {
-        return m_functor.get_name();
+    // The widest range (relative to size) where counting sort beats radix sort
+    thresholds.counting_range_factor = 0;
+    for (size_t factor = 1; factor <= 64; factor *= 2) {
+        generate(size, static_cast<T>(std::min<size_t>(factor * size - 1, std::numeric_limits<T>::max())));
+        if (measure(counting) < measure(radix)) {
+            thresholds.counting_range_factor = factor;
+        }
     }
 
-    void update_cache(std::vector<T>& vec) {
-        m_functor.update_cache(get_vector_data(vec), vec.size());
+    // The largest runs count (relative to size) where natural merge sort beats intro sort
+    thresholds.presorted_runs_ratio = 0;
+    for (double ratio : { 0.001, 0.002, 0.005, 0.01, 0.02, 0.05, 0.1, 0.2 }) {
+        generate(size, std::numeric_limits<T>::max());
+        const size_t runs = std::max<size_t>(1, static_cast<size_t>(ratio * size));
+        for (size_t run = 0; run < runs; ++run) {
+            std::sort(input.begin() + run * size / runs, input.begin() + (run + 1) * size / runs);
+        }
+        if (measure(natural_merge) < measure(intro)) {
+            thresholds.presorted_runs_ratio = ratio;
+        }
     }
 
-    void sort(std::vector<T>& vec) {
-        m_functor.sort(get_vector_data(vec), vec.size());
+    // The smallest distinct values ratio where radix sort beats intro sort
+    thresholds.radix_min_distinct_ratio = 1.0;
+    for (double ratio : { 0.001, 0.01, 0.05, 0.1, 0.25, 0.5, 1.0 }) {
+        generate(std::max<size_t>(1, static_cast<size_t>(ratio * size)), std::numeric_limits<T>::max());
+        std::vector<T> distinct = input;
+        std::uniform_int_distribution<size_t> pick(0, distinct.size() - 1);
+        input.resize(size);
+        std::generate(input.begin(), input.end(), [&]() {
+            return distinct[pick(gen)];
+        });
+        if (measure(radix) < measure(intro)) {
+            thresholds.radix_min_distinct_ratio = ratio;
+            break;
+        }
     }
 
-private:
-    sort_functor<T, Predicate>& m_functor;
-};
+    return thresholds;
+}
 
-int main() {
-    using T = uint32_t;
+template<typename T, typename Predicate, typename Registry>
+void run_benchmark(const benchmark_options& options, std::mt19937& gen, benchmark_log& log) {
     using clock = std::chrono::high_resolution_clock;
     using duration = std::chrono::nanoseconds;
-    using sort_predicate = std::less<T>;
-    using functor_adapter = sort_functor_adapter<T, sort_predicate>;
-
-    std::random_device rd;
-    std::mt19937 gen(rd());
-
-    std::ofstream file("output.txt");
 
     constexpr size_t collectionSize = 50000;
-    std::ostream& log_stream = std::cout;
-    std::ostream& log_file = file;
 
     auto shuffle = [&gen](std::vector<T>& data) {
         std::shuffle(data.begin(), data.end(), gen);
@@ -228,16 +238,17 @@ int main() {
 
     auto generate_unique = [](std::vector<T>& out, size_t count) {
         out.reserve(out.size() + count);
-        for (T i = 0; i < count; ++i) {
-            out.push_back(i);
+        for (size_t i = 0; i < count; ++i) {
+            out.push_back(static_cast<T>(i));
         }
     };
 
-    auto generate_random = [&gen](std::vector<T>& out, size_t count, T min, T max) {
+    // Values are whole numbers for every element type, so floats get duplicates too
+    auto generate_random = [&gen](std::vector<T>& out, size_t count, size_t min, size_t max) {
         out.reserve(out.size() + count);
-        std::uniform_int_distribution<T> duplicatesDistribution(min, max);
+        std::uniform_int_distribution<size_t> duplicatesDistribution(min, max);
         std::generate_n(std::back_inserter(out), count, [&]() {
-            return duplicatesDistribution(gen);
+            return static_cast<T>(duplicatesDistribution(gen));
         });
     };
 
@@ -247,27 +258,31 @@ int main() {
         std::shuffle(out.begin() + count, out.end(), gen);
     };
 
-    std::vector<T> merge_sort_cache;
     std::vector<T> input_data_cache;
     std::vector<T> algorithm_cache;
+    input_data_cache.reserve(collectionSize);
+    algorithm_cache.reserve(collectionSize);
+
+    kernel_settings settings;
+    settings.max_size = collectionSize;
+
+    if constexpr (std::is_integral_v<T>) {
+        if (options.kernel_selected(auto_sort_kernel<T, Predicate>::id())) {
+            log.println("Calibrating auto sort thresholds");
+            settings.auto_sort_thresholds = calibrate_auto_sort<T>(gen, collectionSize);
+            log.println("   small_size = ", settings.auto_sort_thresholds.small_size);
+            log.println("   presorted_runs_ratio = ", settings.auto_sort_thresholds.presorted_runs_ratio);
+            log.println("   counting_range_factor = ", settings.auto_sort_thresholds.counting_range_factor);
+            log.println("   radix_min_size = ", settings.auto_sort_thresholds.radix_min_size);
+            log.println("   radix_min_distinct_ratio = ", settings.auto_sort_thresholds.radix_min_distinct_ratio);
+            log.println();
+        }
+    }
 
-    std::vector<std::unique_ptr<sort_functor<T, sort_predicate>>>  functors;
-    functors.push_back(std::make_unique<bubble_sort_functor<T, sort_predicate>>());
-    functors.push_back(std::make_unique<counting_sort_functor<T, sort_predicate>>());
-    functors.push_back(std::make_unique<merge_sort_functor<T, sort_predicate>>());
-    functors.push_back(std::make_unique<quick_sort_functor<T, sort_predicate>>());
-    functors.push_back(std::make_unique<heap_sort_functor<T, sort_predicate>>());
-    functors.push_back(std::make_unique<radix_sort_msd_functor<T, sort_predicate>>());
-    functors.push_back(std::make_unique<radix_sort_lsd_functor<T, sort_predicate>>());
-
-    auto print = [&log_stream, &log_file](auto... args) {
-        (log_stream << ... << args);
-        (log_file << ... << args);
-    };
-
-    auto println = [&print](auto... args) {
-        print(args..., '\n');
-    };
+    typename Registry::template instance<T, Predicate> kernels;
+    for_each_kernel(kernels, options, [&](auto& kernel) {
+        kernel.prepare(settings);
+    });
 
     auto get_process_duration = [](auto&& fn) {
         auto t1 = clock::now();
@@ -277,133 +292,482 @@ int main() {
     };
 
     auto print_table_header = [&]() {
-        print("N,");
-        for (auto& functor : functors) {
-            print(functor->get_name(), ',');
-        }
-        println();
+        log.print("N,");
+        for_each_kernel(kernels, options, [&](auto& kernel) {
+            log.print(kernel.name(), ',');
+        });
+        log.println();
+    };
+
+    // Copies prepared input to cache and measures sorting time of every kernel
+    auto measure_kernels = [&](size_t test_size) {
+        for_each_kernel(kernels, options, [&](auto& kernel) {
+            algorithm_cache.resize(test_size);
+            std::copy_n(input_data_cache.begin(), test_size, algorithm_cache.begin());
+            // Empty cell: kernel would need too much memory for this input
+            if (!kernel_accepts(kernel, get_vector_data(algorithm_cache), algorithm_cache.size())) {
+                log.print(',');
+                return;
+            }
+
+            kernel.update_cache(get_vector_data(algorithm_cache), algorithm_cache.size());
+            const duration time = get_process_duration([&] {
+                kernel.sort(get_vector_data(algorithm_cache), algorithm_cache.size());
+            });
+
+            log.print(time.count(), ',');
+        });
+        log.println();
     };
 
     {
-        println("Check that sorting functions work in the same way as std::sort");
+        log.println("Check that sorting functions work in the same way as std::sort");
         input_data_cache.clear();
-        generate_random(input_data_cache, collectionSize, 0, static_cast<T>(collectionSize));
+        generate_random(input_data_cache, collectionSize, 0, collectionSize);
 
         std::vector<T> std_sorted = input_data_cache;
-        presort_part(std_sorted, std_sorted.size(), sort_predicate{});
+        presort_part(std_sorted, std_sorted.size(), Predicate{});
 
-        for (auto& functor : functors) {
-            functor_adapter f{*functor };
-            print("   ", functor->get_name(), ": ");
+        for_each_kernel(kernels, options, [&](auto& kernel) {
+            log.print("   ", kernel.name(), ": ");
             algorithm_cache = input_data_cache;
-            f.update_cache(algorithm_cache);
-            f.sort(algorithm_cache);
+            if (!kernel_accepts(kernel, get_vector_data(algorithm_cache), algorithm_cache.size())) {
+                log.println("skipped");
+                return;
+            }
+
+            kernel.update_cache(get_vector_data(algorithm_cache), algorithm_cache.size());
+            kernel.sort(get_vector_data(algorithm_cache), algorithm_cache.size());
             if (algorithm_cache == std_sorted) {
-                println("OK");
+                log.println("OK");
             } else {
-                println("FAILED");
+                log.println("FAILED");
             }
+        });
+        log.println();
+    }
+
+    {
+        log.println("Check that sort_by_key works in the same way as std::stable_sort");
+        input_data_cache.clear();
+        generate_random(input_data_cache, collectionSize, 0, collectionSize / 4);
+
+        // Payload keeps original position, wide payload is a 64 byte record
+        using wide_payload = std::array<uint32_t, 16>;
+        std::vector<std::pair<T, uint32_t>> expected;
+        for (size_t i = 0; i < input_data_cache.size(); ++i) {
+            expected.emplace_back(input_data_cache[i], static_cast<uint32_t>(i));
         }
-        println();
+        std::stable_sort(expected.begin(), expected.end(), [](const auto& a, const auto& b) {
+            return Predicate{}(a.first, b.first);
+        });
+
+        sort::scratch_arena arena;
+        auto check = [&](std::string_view name, auto payload) {
+            using payload_t = decltype(payload);
+            algorithm_cache = input_data_cache;
+            std::vector<payload_t> values(algorithm_cache.size());
+            for (size_t i = 0; i < values.size(); ++i) {
+                values[i] = payload_t{ static_cast<uint32_t>(i) };
+            }
+
+            sort::sort_by_key(get_vector_data(algorithm_cache), get_vector_data(values), algorithm_cache.size(), arena, Predicate{});
+
+            bool ok = true;
+            for (size_t i = 0; i < expected.size(); ++i) {
+                ok = ok && algorithm_cache[i] == expected[i].first && values[i] == payload_t{ expected[i].second };
+            }
+            log.println("   ", name, ": ", ok ? "OK" : "FAILED");
+        };
+
+        check("32-bit payload", uint32_t{});
+        check("64 byte payload", wide_payload{});
+        log.println();
     }
 
     {
-        println("Sorting time as function of collection size");
+        log.println("Sorting time as function of collection size");
         print_table_header();
-    
+
         const size_t steps_count = 100;
         const size_t step_size = collectionSize / steps_count;
         static_assert((collectionSize % steps_count) == 0);
-    
+
         // Prepare data for the whole test
         input_data_cache.clear();
-        generate_random(input_data_cache, collectionSize, 0, static_cast<T>(collectionSize));
-    
+        generate_random(input_data_cache, collectionSize, 0, collectionSize);
+
         for (size_t i = 1; i <= steps_count; ++i) {
             const size_t test_size = step_size * i;
-            print(test_size, ',');
-            for (auto& functor : functors) {
-                // copy first n from generated in cache
-                algorithm_cache.resize(test_size);
-                std::copy_n(input_data_cache.begin(), test_size, algorithm_cache.begin());
-                functor_adapter f{ *functor };
-                f.update_cache(algorithm_cache);
-                const duration time = get_process_duration([&] {
-                    f.sort(algorithm_cache);
-                });
-    
-                print(time.count(), ',');
-            }
-            println();
+            log.print(test_size, ',');
+            measure_kernels(test_size);
         }
-        println();
+        log.println();
     }
-    
+
     {
-        println("Sorting time as function of sorted part size");
+        log.println("Sorting time as function of sorted part size");
         print_table_header();
-    
+
         const size_t steps_count = 100;
         const size_t step_size = collectionSize / steps_count;
         static_assert((collectionSize % steps_count) == 0);
-    
+
         // Prepare common test data
         input_data_cache.clear();
-        generate_random(input_data_cache, collectionSize, 0, static_cast<T>(collectionSize));
-    
+        generate_random(input_data_cache, collectionSize, 0, collectionSize);
+
         for (size_t i = 1; i <= steps_count; ++i) {
             const size_t test_size = step_size * i;
             auto percents = (100.f * i) / steps_count;
-            print(percents, ',');
-            presort_part(input_data_cache, test_size, sort_predicate{});
-            for (auto& functor : functors) {
-                algorithm_cache = input_data_cache;
-                functor_adapter f{ *functor };
-                f.update_cache(algorithm_cache);
-                const duration time = get_process_duration([&] {
-                    f.sort(algorithm_cache);
-                });
-    
-                print(time.count(), ',');
-            }
-            println();
+            log.print(percents, ',');
+            presort_part(input_data_cache, test_size, Predicate{});
+            measure_kernels(input_data_cache.size());
         }
-        println();
+        log.println();
     }
-    
+
     {
-        println("Sorting time as function of duplicated elements percent");
+        log.println("Sorting time as function of duplicated elements percent");
         print_table_header();
-    
+
         const size_t steps_count = 100;
         const size_t step_size = collectionSize / steps_count;
         static_assert((collectionSize % steps_count) == 0);
-    
+
         for (size_t i = 1; i <= steps_count; ++i) {
-            const size_t duplicates = step_size * i;
-            const size_t unique = std::max(size_t{ 1 }, collectionSize - duplicates);
+            // At least one unique value: inputs never exceed collectionSize the kernels are prepared for
+            const size_t unique = std::max(size_t{ 1 }, collectionSize - step_size * i);
+            const size_t duplicates = collectionSize - unique;
             auto percents = (100.f * duplicates) / collectionSize;
-            print(percents, ',');
+            log.print(percents, ',');
             input_data_cache.clear();
             generate_unique(input_data_cache, unique);
-            generate_random(input_data_cache, duplicates, 0, static_cast<T>(unique) - 1);
+            generate_random(input_data_cache, duplicates, 0, unique - 1);
             shuffle(input_data_cache);
-            for (auto& functor : functors) {
-                // copy first n from generated in cache
-                algorithm_cache = input_data_cache;
-                functor_adapter f{ *functor };
-                f.update_cache(algorithm_cache);
-                const duration time = get_process_duration([&] {
-                    f.sort(algorithm_cache);
-                });
-    
-                print(time.count(), ',');
+            assert(input_data_cache.size() <= settings.max_size);
+            measure_kernels(input_data_cache.size());
+        }
+        log.println();
+    }
+
+    {
+        log.println("Selection of k smallest elements: time as function of k/n percent");
+        log.println("k/n,Intro Sort (full),Partial Sort,Nth Element,Top K,std::partial_sort,std::nth_element,");
+
+        input_data_cache.clear();
+        generate_random(input_data_cache, collectionSize, 0, collectionSize);
+
+        std::vector<T> std_sorted = input_data_cache;
+        std::sort(std_sorted.begin(), std_sorted.end(), Predicate{});
+
+        auto equivalent = [](const T& a, const T& b) {
+            return !Predicate{}(a, b) && !Predicate{}(b, a);
+        };
+
+        // Sorting selections leave the k smallest elements sorted at the front,
+        // the others put the k-th one in its place with smaller ones before it
+        auto check_selection = [&](size_t k, bool sorted) {
+            if (sorted) {
+                return std::equal(algorithm_cache.begin(), algorithm_cache.begin() + k, std_sorted.begin(), equivalent);
+            }
+
+            const T& nth = algorithm_cache[k - 1];
+            return equivalent(nth, std_sorted[k - 1]) &&
+                std::none_of(algorithm_cache.begin(), algorithm_cache.begin() + (k - 1), [&](const T& v) { return Predicate{}(nth, v); }) &&
+                std::none_of(algorithm_cache.begin() + k, algorithm_cache.end(), [&](const T& v) { return Predicate{}(v, nth); });
+        };
+
+        bool all_ok = true;
+        auto measure_selection = [&](size_t k, bool sorted, auto&& select) {
+            algorithm_cache = input_data_cache;
+            const duration time = get_process_duration([&] {
+                select(k);
+            });
+            all_ok = all_ok && check_selection(k, sorted);
+            log.print(time.count(), ',');
+        };
+
+        for (double percents : { 0.1, 1.0, 5.0, 10.0, 25.0, 50.0, 75.0, 100.0 }) {
+            const size_t k = std::max<size_t>(1, static_cast<size_t>(percents / 100 * collectionSize));
+            const size_t n = input_data_cache.size();
+            log.print(percents, ',');
+
+            measure_selection(k, true, [&](size_t) {
+                sort::intro_sort(get_vector_data(algorithm_cache), n, Predicate{});
+            });
+            measure_selection(k, true, [&](size_t k) {
+                sort::partial_sort(get_vector_data(algorithm_cache), n, k, Predicate{});
+            });
+            measure_selection(k, false, [&](size_t k) {
+                sort::nth_element(get_vector_data(algorithm_cache), n, k - 1, Predicate{});
+            });
+            measure_selection(k, true, [&](size_t k) {
+                sort::top_k<T, Predicate> selector(k);
+                selector.push(get_vector_data(algorithm_cache), n);
+                const std::vector<T> smallest = selector.take_sorted();
+                std::copy(smallest.begin(), smallest.end(), algorithm_cache.begin());
+            });
+            measure_selection(k, true, [&](size_t k) {
+                std::partial_sort(algorithm_cache.begin(), algorithm_cache.begin() + k, algorithm_cache.end(), Predicate{});
+            });
+            measure_selection(k, false, [&](size_t k) {
+                std::nth_element(algorithm_cache.begin(), algorithm_cache.begin() + (k - 1), algorithm_cache.end(), Predicate{});
+            });
+            log.println();
+        }
+        log.println("Selection results: ", all_ok ? "OK" : "FAILED");
+        log.println();
+    }
+
+    {
+        log.println("Set operations on sorted arrays: time as function of sizes ratio");
+        log.println("Ratio,Intersect,Intersect (merge),Intersect (galloping),std::set_intersection,Union,std::set_union,Difference,std::set_difference,Merge Join,");
+
+        auto equivalent = [](const T& a, const T& b) {
+            return !Predicate{}(a, b) && !Predicate{}(b, a);
+        };
+
+        // Sets are sorted arrays without equivalent elements
+        auto generate_set = [&](std::vector<T>& out, size_t count) {
+            out.clear();
+            generate_random(out, count, 0, 2 * collectionSize);
+            std::sort(out.begin(), out.end(), Predicate{});
+            out.erase(std::unique(out.begin(), out.end(), equivalent), out.end());
+        };
+
+        bool all_ok = true;
+        std::vector<T> large;
+        std::vector<T> small;
+        std::vector<T> expected;
+        std::vector<T> result;
+
+        auto measure_operation = [&](auto&& operation) {
+            result.assign(large.size() + small.size(), T{});
+            size_t count = 0;
+            const duration time = get_process_duration([&] {
+                count = operation(get_vector_data(result));
+            });
+            result.resize(count);
+            all_ok = all_ok && std::equal(result.begin(), result.end(), expected.begin(), expected.end(), equivalent);
+            log.print(time.count(), ',');
+        };
+
+        for (size_t ratio : { 1, 4, 16, 64, 256, 1024 }) {
+            generate_set(large, collectionSize);
+            generate_set(small, collectionSize / ratio);
+            const T* a = get_vector_data(large);
+            const T* b = get_vector_data(small);
+            const size_t a_size = large.size();
+            const size_t b_size = small.size();
+            log.print(ratio, ',');
+
+            expected.clear();
+            std::set_intersection(large.begin(), large.end(), small.begin(), small.end(), std::back_inserter(expected), Predicate{});
+            measure_operation([&](T* out) {
+                return sort::sorted_intersect(a, a_size, b, b_size, out, Predicate{});
+            });
+            measure_operation([&](T* out) {
+                Predicate predicate;
+                return sort::set_operations_impl::intersect_merge(a, a_size, b, b_size, out, predicate);
+            });
+            measure_operation([&](T* out) {
+                Predicate predicate;
+                return sort::set_operations_impl::intersect_galloping(a, a_size, b, b_size, out, predicate);
+            });
+            measure_operation([&](T* out) {
+                return static_cast<size_t>(std::set_intersection(a, a + a_size, b, b + b_size, out, Predicate{}) - out);
+            });
+
+            const std::vector<T> intersection = expected;
+            expected.clear();
+            std::set_union(large.begin(), large.end(), small.begin(), small.end(), std::back_inserter(expected), Predicate{});
+            measure_operation([&](T* out) {
+                return sort::sorted_union(a, a_size, b, b_size, out, Predicate{});
+            });
+            measure_operation([&](T* out) {
+                return static_cast<size_t>(std::set_union(a, a + a_size, b, b + b_size, out, Predicate{}) - out);
+            });
+
+            expected.clear();
+            std::set_difference(large.begin(), large.end(), small.begin(), small.end(), std::back_inserter(expected), Predicate{});
+            measure_operation([&](T* out) {
+                return sort::sorted_difference(a, a_size, b, b_size, out, Predicate{});
+            });
+            measure_operation([&](T* out) {
+                return static_cast<size_t>(std::set_difference(a, a + a_size, b, b + b_size, out, Predicate{}) - out);
+            });
+
+            // Values are copies of keys, so every emitted triple must hold the same value three times
+            expected = intersection;
+            measure_operation([&](T* out) {
+                size_t count = 0;
+                sort::merge_join(a, a, a_size, b, b, b_size, [&](const T& key, const T& left, const T& right) {
+                    all_ok = all_ok && equivalent(key, left) && equivalent(key, right);
+                    out[count++] = key;
+                }, Predicate{});
+                return count;
+            });
+            log.println();
+        }
+
+        // Join of keys with repetitions emits all combinations of equivalent entries
+        std::vector<T> left_keys;
+        std::vector<T> right_keys;
+        generate_random(left_keys, 1000, 0, 300);
+        generate_random(right_keys, 500, 0, 300);
+        std::sort(left_keys.begin(), left_keys.end(), Predicate{});
+        std::sort(right_keys.begin(), right_keys.end(), Predicate{});
+        std::vector<size_t> left_indices(left_keys.size());
+        std::vector<size_t> right_indices(right_keys.size());
+        std::iota(left_indices.begin(), left_indices.end(), size_t{ 0 });
+        std::iota(right_indices.begin(), right_indices.end(), size_t{ 0 });
+
+        size_t expected_pairs = 0;
+        for (const T& l : left_keys) {
+            expected_pairs += std::count_if(right_keys.begin(), right_keys.end(), [&](const T& r) { return equivalent(l, r); });
+        }
+
+        size_t emitted = 0;
+        const size_t joined = sort::merge_join(
+            get_vector_data(left_keys), get_vector_data(left_indices), left_keys.size(),
+            get_vector_data(right_keys), get_vector_data(right_indices), right_keys.size(),
+            [&](const T& key, size_t l, size_t r) {
+                all_ok = all_ok && equivalent(key, left_keys[l]) && equivalent(key, right_keys[r]);
+                ++emitted;
+            }, Predicate{});
+        all_ok = all_ok && joined == expected_pairs && emitted == expected_pairs;
+
+        log.println("Set operations results: ", all_ok ? "OK" : "FAILED");
+        log.println();
+    }
+}
+
+template<typename T, template<typename> typename... Predicates>
+void run_for_type(predicate_list<Predicates...>, const benchmark_options& options, std::mt19937& gen, benchmark_log& log) {
+    auto run = [&](std::string_view predicate_name, auto predicate) {
+        if (options.predicate_selected(predicate_name)) {
+            log.println("Element type: ", type_id<T>(), ", predicate: ", predicate_name);
+            log.println();
+            run_benchmark<T, decltype(predicate), sort_kernels>(options, gen, log);
+        }
+    };
+    (run(predicate_id<Predicates>(), Predicates<T>{}), ...);
+}
+
+template<typename... Ts, typename PredicateList>
+void run_selected(type_list<Ts...>, PredicateList predicates, const benchmark_options& options, std::mt19937& gen, benchmark_log& log) {
+    auto run = [&](std::string_view type_name, auto type_tag) {
+        using T = typename decltype(type_tag)::type;
+        if (options.type_selected(type_name)) {
+            run_for_type<T>(predicates, options, gen, log);
+        }
+    };
+    (run(type_id<Ts>(), type_tag<Ts>{}), ...);
+}
+
+template<typename... Ts, template<typename> typename... Predicates>
+bool validate_options(type_list<Ts...>, predicate_list<Predicates...>, const benchmark_options& options) {
+    auto check = [](const std::vector<std::string>& values, std::string_view what, auto&& is_known) {
+        for (const std::string& value : values) {
+            if (value != "all" && !is_known(value)) {
+                std::cerr << "Unknown " << what << ": " << value << " (see --list)\n";
+                return false;
             }
-            println();
         }
-        println();
+        return true;
+    };
+
+    auto known_type = [](const std::string& value) {
+        return ((value == type_id<Ts>()) || ...);
+    };
+
+    auto known_predicate = [](const std::string& value) {
+        return ((value == predicate_id<Predicates>()) || ...);
+    };
+
+    auto known_kernel = [](const std::string& value) {
+        bool known = false;
+        sort_kernels::for_each_id([&](std::string_view id, std::string_view) {
+            known = known || value == id;
+        });
+        return known;
+    };
+
+    return check(options.types, "type", known_type) &&
+        check(options.predicates, "predicate", known_predicate) &&
+        check(options.kernels, "kernel", known_kernel);
+}
+
+template<typename... Ts, template<typename> typename... Predicates>
+void print_registry(type_list<Ts...>, predicate_list<Predicates...>) {
+    std::cout << "Kernels:\n";
+    sort_kernels::for_each_id([](std::string_view id, std::string_view name) {
+        std::cout << "   " << std::left << std::setw(24) << id << name << '\n';
+    });
+    std::cout << "Types:";
+    ((std::cout << ' ' << type_id<Ts>()), ...);
+    std::cout << "\nPredicates:";
+    ((std::cout << ' ' << predicate_id<Predicates>()), ...);
+    std::cout << '\n';
+}
+
+bool parse_options(int argc, char** argv, benchmark_options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--list") {
+            options.list = true;
+            continue;
+        }
+
+        if (i + 1 == argc) {
+            return false;
+        }
+
+        const std::string_view value = argv[++i];
+        if (arg == "--types") {
+            options.types = split_list(value);
+        }
+        else if (arg == "--predicates") {
+            options.predicates = split_list(value);
+        }
+        else if (arg == "--kernels") {
+            options.kernels = split_list(value);
+        }
+        else {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char** argv) {
+    benchmark_options options;
+    if (!parse_options(argc, argv, options)) {
+        std::cerr << "Usage: " << argv[0] << " [--list] [--types t1,t2|all] [--predicates p1,p2|all] [--kernels k1,k2|all]\n";
+        return 1;
     }
 
-    system("pause");
+    if (options.list) {
+        print_registry(element_types{}, sort_predicates{});
+        return 0;
+    }
+
+    if (!validate_options(element_types{}, sort_predicates{}, options)) {
+        return 1;
+    }
+
+    std::random_device rd;
+    std::mt19937 gen(rd());
+
+    std::ofstream file("output.txt");
+    benchmark_log log(std::cout, file);
+
+    log.println("Sorting networks instruction set: ", sort::simd::isa_name(sort::simd::best_isa()));
+    log.println();
+
+    run_selected(element_types{}, sort_predicates{}, options, gen, log);
+
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,237 @@
+#pragma once
+
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "integer_sort.h"
+#include "merge_sort.h"
+#include "quick_sort.h"
+#include "scratch_arena.h"
+
+namespace sort
+{
+    /// Decision points of auto_sort. Defaults are rough; lab 4 benchmark can calibrate them.
+    struct auto_sort_thresholds
+    {
+        /// Smaller arrays go to intro sort without looking at statistics
+        size_t small_size = 64;
+
+        /// Natural merge sort is used when runs count <= presorted_runs_ratio * size
+        double presorted_runs_ratio = 0.02;
+
+        /// Counting sort is used when integer range <= counting_range_factor * size
+        size_t counting_range_factor = 4;
+
+        /// Radix sort needs at least that many integers to pay off its passes
+        size_t radix_min_size = 4096;
+
+        /// Radix sort is used only when estimated distinct values ratio >= this
+        /// (quick sort partitions with many equal keys finish early)
+        double radix_min_distinct_ratio = 0.05;
+    };
+
+    enum class auto_sort_algorithm
+    {
+        intro_sort,
+        natural_merge_sort,
+        counting_sort,
+        radix_sort
+    };
+
+    inline const char* auto_sort_algorithm_name(auto_sort_algorithm algorithm) {
+        switch (algorithm) {
+        case auto_sort_algorithm::natural_merge_sort:
+            return "natural merge sort";
+        case auto_sort_algorithm::counting_sort:
+            return "counting sort";
+        case auto_sort_algorithm::radix_sort:
+            return "radix sort";
+        default:
+            return "intro sort";
+        }
+    }
+
+    template<typename T>
+    struct input_statistics
+    {
+        size_t size = 0;
+
+        /// Count of non-descending runs
+        size_t runs_count = 0;
+
+        /// Estimated count of distinct values / size (integers only, 1 otherwise)
+        double distinct_ratio = 1.0;
+
+        /// Minimal and maximal keys (integers only)
+        std::make_unsigned_t<std::conditional_t<std::is_integral_v<T>, T, unsigned>> min_key = 0;
+        std::make_unsigned_t<std::conditional_t<std::is_integral_v<T>, T, unsigned>> max_key = 0;
+    };
+}
+
+namespace sort::auto_sort_impl
+{
+    // Linear counting sketch of distinct values.
+    // Sketch is sized by input (up to the max size) to keep small arrays cheap
+    constexpr size_t max_sketch_bits_log2 = 16;
+    constexpr size_t min_sketch_bits_log2 = 10;
+    constexpr size_t max_sketch_words = (size_t{ 1 } << max_sketch_bits_log2) / 64;
+
+    inline size_t sketch_bits_log2(size_t size) {
+        size_t bits_log2 = min_sketch_bits_log2;
+        while (bits_log2 < max_sketch_bits_log2 && (size_t{ 1 } << bits_log2) < size) {
+            ++bits_log2;
+        }
+        return bits_log2;
+    }
+
+    /// Fibonacci hashing: high bits of the product are well mixed
+    inline size_t sketch_index(uint64_t key, size_t bits_log2) {
+        return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> (64 - bits_log2));
+    }
+
+    inline double estimate_distinct(const uint64_t* sketch, size_t bits_log2, size_t size) {
+        const size_t bits = size_t{ 1 } << bits_log2;
+        size_t zeros = 0;
+        for (size_t i = 0; i < bits / 64; ++i) {
+            zeros += std::bitset<64>(~sketch[i]).count();
+        }
+
+        // Saturated sketch: too many distinct values to count
+        if (zeros == 0) {
+            return static_cast<double>(size);
+        }
+
+        const double m = static_cast<double>(bits);
+        return m * std::log(m / static_cast<double>(zeros));
+    }
+}
+
+namespace sort
+{
+    /// Collects statistics for auto_sort in one pass over array
+    template<typename T, typename Predicate = std::less<T>>
+    input_statistics<T> collect_statistics(const T* array, size_t size, Predicate predicate = Predicate()) {
+        using namespace auto_sort_impl;
+
+        input_statistics<T> statistics;
+        statistics.size = size;
+        if (size == 0) {
+            return statistics;
+        }
+
+        statistics.runs_count = 1;
+        if constexpr (std::is_integral_v<T>) {
+            using key_type = decltype(statistics.min_key);
+            const size_t bits_log2 = sketch_bits_log2(size);
+            uint64_t sketch[max_sketch_words];
+            std::fill_n(sketch, (size_t{ 1 } << bits_log2) / 64, 0);
+            key_type min_key = std::numeric_limits<key_type>::max();
+            key_type max_key = 0;
+            for (size_t i = 0; i < size; ++i) {
+                const key_type key = radix_sort_impl::to_unsigned_key(array[i]);
+                min_key = std::min(min_key, key);
+                max_key = std::max(max_key, key);
+                const size_t bit = sketch_index(key, bits_log2);
+                sketch[bit / 64] |= uint64_t{ 1 } << (bit % 64);
+                if (i > 0 && predicate(array[i], array[i - 1])) {
+                    ++statistics.runs_count;
+                }
+            }
+
+            statistics.min_key = min_key;
+            statistics.max_key = max_key;
+            const double distinct = std::min(estimate_distinct(sketch, bits_log2, size), static_cast<double>(size));
+            statistics.distinct_ratio = distinct / static_cast<double>(size);
+        }
+        else {
+            for (size_t i = 1; i < size; ++i) {
+                if (predicate(array[i], array[i - 1])) {
+                    ++statistics.runs_count;
+                }
+            }
+        }
+
+        return statistics;
+    }
+
+    template<typename T, typename Predicate = std::less<T>>
+    auto_sort_algorithm choose_sort_algorithm(const input_statistics<T>& statistics, const auto_sort_thresholds& thresholds) {
+        const size_t size = statistics.size;
+        if (size <= thresholds.small_size) {
+            return auto_sort_algorithm::intro_sort;
+        }
+
+        if (static_cast<double>(statistics.runs_count) <= thresholds.presorted_runs_ratio * static_cast<double>(size)) {
+            return auto_sort_algorithm::natural_merge_sort;
+        }
+
+        // Key based sorts order by std::less only
+        if constexpr (std::is_integral_v<T> && std::is_same_v<std::decay_t<Predicate>, std::less<T>>) {
+            const auto span = statistics.max_key - statistics.min_key;
+            if (thresholds.counting_range_factor != 0 && span / thresholds.counting_range_factor < size) {
+                // Same test as integer_sort: counting_histograms_count keeps memory O(max(range, size))
+                return auto_sort_algorithm::counting_sort;
+            }
+
+            if (size >= thresholds.radix_min_size && statistics.distinct_ratio >= thresholds.radix_min_distinct_ratio) {
+                return auto_sort_algorithm::radix_sort;
+            }
+        }
+
+        return auto_sort_algorithm::intro_sort;
+    }
+
+    /// Sorts array with algorithm chosen from input statistics
+    /// Temporary memory comes from 'arena' (it's reset before return)
+    /// Returns the algorithm that was used
+    template<typename T, typename Predicate = std::less<T>>
+    auto_sort_algorithm auto_sort(
+        T* array,
+        size_t size,
+        scratch_arena& arena,
+        const auto_sort_thresholds& thresholds = auto_sort_thresholds{},
+        Predicate predicate = Predicate())
+    {
+        const input_statistics<T> statistics = collect_statistics(array, size, predicate);
+        const auto_sort_algorithm algorithm = choose_sort_algorithm<T, Predicate>(statistics, thresholds);
+        switch (algorithm) {
+        case auto_sort_algorithm::natural_merge_sort:
+            if constexpr (std::is_trivially_copyable_v<T>) {
+                T* buffer = arena.allocate<T>(size);
+                natural_merge_sort(array, buffer, size, predicate);
+            }
+            else {
+                std::vector<T> buffer(size);
+                natural_merge_sort(array, buffer.data(), size, predicate);
+            }
+            break;
+        case auto_sort_algorithm::counting_sort:
+        case auto_sort_algorithm::radix_sort:
+            if constexpr (std::is_integral_v<T>) {
+                // Statistics already have min and max: go straight to the kernels
+                using namespace integer_sort_impl;
+                const size_t threads_count = choose_threads_count(size, integer_sort_options{});
+                const auto min = statistics.min_key;
+                const auto span = static_cast<key_t<T>>(statistics.max_key - statistics.min_key);
+                if (algorithm == auto_sort_algorithm::counting_sort) {
+                    counting_sort_keys(array, size, min, static_cast<size_t>(span) + 1, threads_count, arena);
+                }
+                else {
+                    radix_sort_keys(array, size, min, span, threads_count, arena);
+                }
+            }
+            break;
+        default:
+            intro_sort(array, size, predicate);
+            break;
+        }
+
+        arena.reset();
+        return algorithm;
+    }
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <algorithm>
+#include <type_traits>
 
 namespace sort
 {
@@ -13,23 +14,23 @@ namespace sort
         typename T,
         typename Enable = std::enable_if_t<std::is_integral_v<T>>
     >
-    void counting_sort(T* array, T* counts, size_t size, T min, T max) {
+    void counting_sort(T* array, size_t* counts, size_t size, T min, T max) {
         if (size < 2) {
             return;
         }
 
-        const size_t range = max - min + 1;
+        // Unsigned arithmetic: difference of signed values may not fit in T
+        using U = std::make_unsigned_t<T>;
+        const size_t range = static_cast<size_t>(static_cast<U>(static_cast<U>(max) - static_cast<U>(min))) + 1;
         std::fill_n(counts, range, 0);
 
-        for (T i = 0; i < size; ++i) {
-            ++counts[array[i] - min];
+        for (size_t i = 0; i < size; ++i) {
+            ++counts[static_cast<U>(static_cast<U>(array[i]) - static_cast<U>(min))];
         }
 
-        for (T i = min; i <= max; ++i) {
-            const size_t count = counts[i - min];
-            for (size_t j = 0; j < count; ++j) {
-                *array++ = i;
-            }
+        for (size_t offset = 0; offset < range; ++offset) {
+            const T value = static_cast<T>(static_cast<U>(static_cast<U>(min) + offset));
+            array = std::fill_n(array, counts[offset], value);
         }
     }
 }
@@ -0,0 +1,535 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(_WIN32)
+#include <stdio.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "integer_sort.h"
+#include "loser_tree.h"
+#include "quick_sort.h"
+
+namespace sort
+{
+    struct external_sort_options
+    {
+        /// Memory for element buffers in bytes
+        size_t memory_budget = size_t{ 256 } << 20;
+
+        /// The largest read or write request in bytes
+        size_t io_block_size = size_t{ 1 } << 20;
+
+        /// Directory for runs, empty - system temporary directory
+        std::filesystem::path temp_directory;
+
+        /// 0 - use all hardware threads
+        size_t threads_count = 0;
+    };
+
+    struct external_sort_statistics
+    {
+        uint64_t bytes = 0;
+        size_t runs_count = 0;
+        size_t merge_passes = 0;
+        double run_formation_seconds = 0.0;
+        double merge_seconds = 0.0;
+
+        /// Input size divided by total time, MB (2^20 bytes) per second
+        double throughput() const {
+            const double seconds = run_formation_seconds + merge_seconds;
+            return seconds > 0.0 ? static_cast<double>(bytes) / (1024.0 * 1024.0) / seconds : 0.0;
+        }
+    };
+}
+
+namespace sort::external_sort_impl
+{
+    // Smaller requests are dominated by system call overhead
+    constexpr size_t min_io_block_size = size_t{ 64 } << 10;
+
+    // Files kept for standard streams and files the caller has open
+    constexpr size_t reserved_open_files = 16;
+
+    /// Files the sort may open at once: process limit minus reserved ones
+    inline size_t max_open_files() {
+#if defined(_WIN32)
+        // Limit of C runtime streams, not of system handles
+        const size_t limit = static_cast<size_t>(_getmaxstdio());
+#else
+        rlimit limits{};
+        if (getrlimit(RLIMIT_NOFILE, &limits) != 0 || limits.rlim_cur == RLIM_INFINITY) {
+            return std::numeric_limits<size_t>::max();
+        }
+        const size_t limit = static_cast<size_t>(limits.rlim_cur);
+#endif
+        return limit > reserved_open_files ? limit - reserved_open_files : 0;
+    }
+
+    class file_handle
+    {
+    public:
+        file_handle(const std::filesystem::path& path, const char* mode) :
+            m_path(path),
+            m_file(std::fopen(path.string().c_str(), mode))
+        {
+            if (m_file == nullptr) {
+                throw std::runtime_error("external_sort: can't open " + path.string());
+            }
+        }
+
+        file_handle(const file_handle&) = delete;
+        file_handle& operator=(const file_handle&) = delete;
+
+        ~file_handle() {
+            if (m_file != nullptr) {
+                std::fclose(m_file);
+            }
+        }
+
+        std::FILE* get() const {
+            return m_file;
+        }
+
+        const std::filesystem::path& path() const {
+            return m_path;
+        }
+
+        // Reports errors of buffered writes
+        void close() {
+            std::FILE* file = m_file;
+            m_file = nullptr;
+            if (std::fclose(file) != 0) {
+                throw std::runtime_error("external_sort: can't write " + m_path.string());
+            }
+        }
+
+    private:
+        std::filesystem::path m_path;
+        std::FILE* m_file;
+    };
+
+    /// Executes I/O requests one by one on a background thread
+    class io_worker
+    {
+    public:
+        io_worker() :
+            m_thread([this]() { run(); })
+        {
+        }
+
+        io_worker(const io_worker&) = delete;
+        io_worker& operator=(const io_worker&) = delete;
+
+        ~io_worker() {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_condition.notify_one();
+            m_thread.join();
+        }
+
+        /// Exceptions of 'fn' are rethrown by future::get()
+        template<typename Fn>
+        auto submit(Fn&& fn) -> std::future<decltype(fn())> {
+            using result_type = decltype(fn());
+            auto task = std::make_shared<std::packaged_task<result_type()>>(std::forward<Fn>(fn));
+            std::future<result_type> result = task->get_future();
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_tasks.emplace_back([task]() { (*task)(); });
+            }
+            m_condition.notify_one();
+            return result;
+        }
+
+    private:
+        void run() {
+            while (true) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_condition.wait(lock, [this]() { return m_stop || !m_tasks.empty(); });
+                    if (m_tasks.empty()) {
+                        return;
+                    }
+                    task = std::move(m_tasks.front());
+                    m_tasks.pop_front();
+                }
+                task();
+            }
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::deque<std::function<void()>> m_tasks;
+        bool m_stop = false;
+        // The last member: starts when the rest is constructed
+        std::thread m_thread;
+    };
+
+    /// Sequential reader of a run with one block of read-ahead
+    template<typename T>
+    class run_reader
+    {
+    public:
+        run_reader(const std::filesystem::path& path, size_t block_elements, io_worker& worker) :
+            m_file(path, "rb"),
+            m_buffer(block_elements),
+            m_next(block_elements),
+            m_worker(worker)
+        {
+            request_next();
+            load_next();
+        }
+
+        run_reader(const run_reader&) = delete;
+        run_reader& operator=(const run_reader&) = delete;
+
+        ~run_reader() {
+            if (m_pending.valid()) {
+                m_pending.wait();
+            }
+        }
+
+        /// nullptr when run is exhausted
+        const T* current() const {
+            return m_position < m_size ? m_buffer.data() + m_position : nullptr;
+        }
+
+        const T* next() {
+            if (++m_position == m_size) {
+                load_next();
+            }
+            return current();
+        }
+
+    private:
+        void request_next() {
+            m_pending = m_worker.submit([this]() {
+                const size_t count = std::fread(m_next.data(), sizeof(T), m_next.size(), m_file.get());
+                if (count < m_next.size() && std::ferror(m_file.get())) {
+                    throw std::runtime_error("external_sort: can't read " + m_file.path().string());
+                }
+                return count;
+            });
+        }
+
+        void load_next() {
+            if (!m_pending.valid()) {
+                m_size = 0;
+                m_position = 0;
+                return;
+            }
+
+            const size_t count = m_pending.get();
+            std::swap(m_buffer, m_next);
+            m_size = count;
+            m_position = 0;
+            // Short read means the end of run
+            if (count == m_buffer.size()) {
+                request_next();
+            }
+        }
+
+    private:
+        file_handle m_file;
+        std::vector<T> m_buffer;
+        std::vector<T> m_next;
+        size_t m_size = 0;
+        size_t m_position = 0;
+        io_worker& m_worker;
+        std::future<size_t> m_pending;
+    };
+
+    /// Sequential writer: one block is filled while the previous one is written
+    template<typename T>
+    class run_writer
+    {
+    public:
+        run_writer(const std::filesystem::path& path, size_t block_elements, io_worker& worker) :
+            m_file(path, "wb"),
+            m_buffer(block_elements),
+            m_spare(block_elements),
+            m_worker(worker)
+        {
+        }
+
+        run_writer(const run_writer&) = delete;
+        run_writer& operator=(const run_writer&) = delete;
+
+        ~run_writer() {
+            if (m_pending.valid()) {
+                m_pending.wait();
+            }
+        }
+
+        void push(const T& value) {
+            m_buffer[m_size++] = value;
+            if (m_size == m_buffer.size()) {
+                flush();
+            }
+        }
+
+        void finish() {
+            if (m_size != 0) {
+                flush();
+            }
+            wait_pending();
+            m_file.close();
+        }
+
+    private:
+        void wait_pending() {
+            if (m_pending.valid()) {
+                m_pending.get();
+            }
+        }
+
+        void flush() {
+            wait_pending();
+            std::swap(m_buffer, m_spare);
+            const size_t count = m_size;
+            m_size = 0;
+            m_pending = m_worker.submit([this, count]() {
+                if (std::fwrite(m_spare.data(), sizeof(T), count, m_file.get()) != count) {
+                    throw std::runtime_error("external_sort: can't write " + m_file.path().string());
+                }
+            });
+        }
+
+    private:
+        file_handle m_file;
+        std::vector<T> m_buffer;
+        std::vector<T> m_spare;
+        size_t m_size = 0;
+        io_worker& m_worker;
+        std::future<void> m_pending;
+    };
+
+    /// Names temporary runs and removes the ones left on exit
+    class temp_files
+    {
+    public:
+        temp_files(std::filesystem::path directory) :
+            m_directory(std::move(directory)),
+            m_prefix("sort_run_" + std::to_string(std::random_device()()) + "_")
+        {
+        }
+
+        temp_files(const temp_files&) = delete;
+        temp_files& operator=(const temp_files&) = delete;
+
+        ~temp_files() {
+            for (const auto& path : m_paths) {
+                std::error_code error;
+                std::filesystem::remove(path, error);
+            }
+        }
+
+        std::filesystem::path create() {
+            m_paths.push_back(m_directory / (m_prefix + std::to_string(m_counter++) + ".tmp"));
+            return m_paths.back();
+        }
+
+        void remove(const std::filesystem::path& path) {
+            std::error_code error;
+            std::filesystem::remove(path, error);
+            m_paths.erase(std::remove(m_paths.begin(), m_paths.end(), path), m_paths.end());
+        }
+
+    private:
+        std::filesystem::path m_directory;
+        std::string m_prefix;
+        size_t m_counter = 0;
+        std::vector<std::filesystem::path> m_paths;
+    };
+
+    /// Sorts slices of chunk in parallel and writes their merge
+    template<typename T, typename Predicate>
+    void write_sorted_chunk(T* chunk, size_t size, size_t threads_count, run_writer<T>& writer, const Predicate& predicate) {
+        threads_count = std::max<size_t>(1, std::min(threads_count, size));
+        integer_sort_impl::parallel_chunks(threads_count, size, [&](size_t, size_t begin, size_t end) {
+            sort::intro_sort<T, Predicate>(chunk + begin, end - begin, predicate);
+        });
+
+        // The same slices as parallel_chunks makes
+        const size_t slice = (size + threads_count - 1) / threads_count;
+        std::vector<const T*> ends(threads_count);
+        loser_tree<T, Predicate> tree(threads_count, predicate);
+        for (size_t t = 0; t < threads_count; ++t) {
+            const size_t begin = std::min(t * slice, size);
+            const size_t end = std::min(begin + slice, size);
+            ends[t] = chunk + end;
+            tree.reset(t, begin < end ? chunk + begin : nullptr);
+        }
+        tree.build();
+
+        while (!tree.empty()) {
+            const T* value = &tree.top();
+            const size_t source = tree.top_source();
+            writer.push(*value);
+            ++value;
+            tree.replace_top(value < ends[source] ? value : nullptr);
+        }
+    }
+
+    template<typename T, typename Predicate>
+    void merge_runs(
+        const std::vector<std::filesystem::path>& runs,
+        const std::filesystem::path& output,
+        size_t block_elements,
+        io_worker& reads,
+        io_worker& writes,
+        const Predicate& predicate)
+    {
+        std::vector<std::unique_ptr<run_reader<T>>> readers;
+        readers.reserve(runs.size());
+        loser_tree<T, Predicate> tree(runs.size(), predicate);
+        for (size_t i = 0; i < runs.size(); ++i) {
+            readers.push_back(std::make_unique<run_reader<T>>(runs[i], block_elements, reads));
+            tree.reset(i, readers.back()->current());
+        }
+        tree.build();
+
+        run_writer<T> writer(output, block_elements, writes);
+        while (!tree.empty()) {
+            writer.push(tree.top());
+            tree.replace_top(readers[tree.top_source()]->next());
+        }
+        writer.finish();
+    }
+}
+
+namespace sort
+{
+    /// Sorts a binary file of fixed-width elements which may not fit into memory.
+    /// Chunks of 'memory_budget' size are sorted by several threads and spilled as runs,
+    /// then runs are merged with a loser tree. Reads are prefetched and writes are
+    /// done in background, one block per run ahead.
+    /// Merge fan-in is limited so each run keeps at least two 64 KB blocks in memory
+    /// and open files stay within the process limit; if there are more runs, several merge passes are made.
+    /// Throws std::runtime_error on I/O errors
+    template<typename T, typename Predicate = std::less<T>>
+    external_sort_statistics external_sort(
+        const std::filesystem::path& input,
+        const std::filesystem::path& output,
+        const external_sort_options& options = {},
+        Predicate predicate = Predicate())
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "external_sort stores elements as raw bytes");
+        using namespace external_sort_impl;
+        using clock = std::chrono::steady_clock;
+        using seconds = std::chrono::duration<double>;
+
+        external_sort_statistics statistics;
+        statistics.bytes = std::filesystem::file_size(input);
+        if (statistics.bytes % sizeof(T) != 0) {
+            throw std::runtime_error("external_sort: input size is not a multiple of element size");
+        }
+
+        const size_t io_block_elements = std::max<size_t>(1, std::max(options.io_block_size, min_io_block_size) / sizeof(T));
+        const size_t io_block_bytes = io_block_elements * sizeof(T);
+        if (options.memory_budget < 4 * io_block_bytes) {
+            throw std::runtime_error("external_sort: memory budget must hold at least four I/O blocks");
+        }
+
+        // Run formation keeps a chunk and two output blocks
+        const size_t chunk_elements = (options.memory_budget - 2 * io_block_bytes) / sizeof(T);
+        // Merge keeps two blocks per input and two for output
+        // and has a file open for every input and the output
+        const size_t min_block_elements = std::max<size_t>(1, min_io_block_size / sizeof(T));
+        const size_t memory_ways = options.memory_budget / (2 * min_block_elements * sizeof(T)) - 1;
+        const size_t open_files = max_open_files();
+        const size_t max_ways = std::max<size_t>(2, std::min(memory_ways, open_files > 0 ? open_files - 1 : 0));
+        auto merge_block_elements = [&](size_t ways) {
+            const size_t fit = options.memory_budget / (2 * (ways + 1) * sizeof(T));
+            return std::clamp(fit, min_block_elements, io_block_elements);
+        };
+
+        const size_t threads_count = options.threads_count != 0 ?
+            options.threads_count :
+            std::max<size_t>(1, std::thread::hardware_concurrency());
+        const uint64_t total_elements = statistics.bytes / sizeof(T);
+
+        io_worker reads;
+        io_worker writes;
+        temp_files temp(options.temp_directory.empty() ? std::filesystem::temp_directory_path() : options.temp_directory);
+        std::vector<std::filesystem::path> runs;
+
+        // 1. Run formation. Input that fits into one chunk goes directly to output
+        const auto formation_start = clock::now();
+        {
+            file_handle in(input, "rb");
+            std::vector<T> chunk(static_cast<size_t>(std::min<uint64_t>(chunk_elements, total_elements)));
+            const bool single_run = total_elements <= chunk_elements;
+            do {
+                const size_t count = std::fread(chunk.data(), sizeof(T), chunk.size(), in.get());
+                if (count < chunk.size() && std::ferror(in.get())) {
+                    throw std::runtime_error("external_sort: can't read " + input.string());
+                }
+                if (count == 0 && !single_run) {
+                    break;
+                }
+
+                const std::filesystem::path run = single_run ? output : temp.create();
+                run_writer<T> writer(run, io_block_elements, writes);
+                write_sorted_chunk(chunk.data(), count, threads_count, writer, predicate);
+                writer.finish();
+                ++statistics.runs_count;
+                if (!single_run) {
+                    runs.push_back(run);
+                }
+                if (count < chunk.size()) {
+                    break;
+                }
+            } while (!single_run);
+        }
+        statistics.run_formation_seconds = seconds(clock::now() - formation_start).count();
+
+        // 2. Merge passes, the last one writes output
+        const auto merge_start = clock::now();
+        while (!runs.empty()) {
+            const bool last_pass = runs.size() <= max_ways;
+            std::vector<std::filesystem::path> merged;
+            for (size_t first = 0; first < runs.size(); first += max_ways) {
+                const std::vector<std::filesystem::path> group(
+                    runs.begin() + first,
+                    runs.begin() + std::min(first + max_ways, runs.size()));
+                merged.push_back(last_pass ? output : temp.create());
+                merge_runs<T>(group, merged.back(), merge_block_elements(group.size()), reads, writes, predicate);
+                for (const auto& run : group) {
+                    temp.remove(run);
+                }
+            }
+            ++statistics.merge_passes;
+            if (last_pass) {
+                break;
+            }
+            runs = std::move(merged);
+        }
+        statistics.merge_seconds = seconds(clock::now() - merge_start).count();
+
+        return statistics;
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+#include <vector>
+
+#include "heap_sort.h"
+
+namespace sort
+{
+    /// Priority queue stored in the same d-ary layout as heap_sort uses.
+    /// top() is the greatest element by 'Predicate' (std::less gives max heap).
+    /// For top-k selection keep k elements with the opposite predicate
+    /// and call replace_top() for every better candidate.
+    template<typename T, typename Predicate = std::less<T>, size_t arity = 4>
+    class heap
+    {
+    public:
+        heap(Predicate predicate = Predicate()) :
+            m_predicate(std::move(predicate))
+        {
+        }
+
+        bool empty() const {
+            return m_values.empty();
+        }
+
+        size_t size() const {
+            return m_values.size();
+        }
+
+        void reserve(size_t capacity) {
+            m_values.reserve(capacity);
+        }
+
+        void clear() {
+            m_values.clear();
+        }
+
+        const T& top() const {
+            assert(!empty());
+            return m_values.front();
+        }
+
+        template<typename... Args>
+        void emplace(Args&&... args) {
+            m_values.emplace_back(std::forward<Args>(args)...);
+            heap_sort_impl::sift_up<arity>(m_values.data(), m_values.size() - 1, m_predicate);
+        }
+
+        void push(T value) {
+            emplace(std::move(value));
+        }
+
+        void pop() {
+            assert(!empty());
+            heap_sort_impl::pop_heap<arity>(m_values.data(), m_values.size(), m_predicate);
+            m_values.pop_back();
+        }
+
+        /// Same as pop() followed by push() but with single sift
+        void replace_top(T value) {
+            assert(!empty());
+            heap_sort_impl::sift_hole_down<arity>(m_values.data(), m_values.size(), 0, std::move(value), m_predicate);
+        }
+
+        /// Heap storage (top is the first element)
+        const T* data() const {
+            return m_values.data();
+        }
+
+        /// Sorts stored elements in ascending order by predicate and moves them out
+        std::vector<T> take_sorted() {
+            for (size_t n = m_values.size(); n > 1; --n) {
+                heap_sort_impl::pop_heap<arity>(m_values.data(), n, m_predicate);
+            }
+            return std::move(m_values);
+        }
+
+    private:
+        Predicate m_predicate;
+        std::vector<T> m_values;
+    };
+}
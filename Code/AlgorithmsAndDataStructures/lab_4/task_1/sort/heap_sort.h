@@ -1,52 +1,144 @@
 #pragma once
 
 #include <algorithm>
+#include <utility>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
 
 namespace sort::heap_sort_impl
 {
-    template<typename T, typename Predicate>
-    void heapify(T* arr, int n, int i, Predicate&& pred) {
-        int largest = i; // Initialize largest as root 
-        int l = 2 * i + 1; // left = 2*i + 1 
-        int r = 2 * i + 2; // right = 2*i + 2 
+    constexpr size_t cache_line_size = 64;
+
+    inline void prefetch(const void* address) {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(address);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#else
+        (void)address;
+#endif
+    }
 
-        // If left child is larger than root 
-        if (l < n && !pred(arr[l], arr[largest]))
-            largest = l;
+    template<size_t arity>
+    constexpr size_t first_child(const size_t index) {
+        return arity * index + 1;
+    }
 
-        // If right child is larger than largest so far 
-        if (r < n && !pred(arr[r], arr[largest]))
-            largest = r;
+    template<size_t arity>
+    constexpr size_t parent(const size_t index) {
+        return (index - 1) / arity;
+    }
 
-        // If largest is not root 
-        if (largest != i) {
-            std::swap(arr[i], arr[largest]);
+    /// Children of all children of 'index' are stored contiguously,
+    /// so they are requested while the current level is compared
+    template<size_t arity, typename T>
+    void prefetch_grandchildren(const T* arr, size_t size, size_t index) {
+        const size_t first = first_child<arity>(first_child<arity>(index));
+        if (first >= size) {
+            return;
+        }
 
-            // Recursively heapify the affected sub-tree 
-            heapify(arr, n, largest, pred);
+        const size_t count = std::min(arity * arity, size - first);
+        const char* begin = reinterpret_cast<const char*>(arr + first);
+        const char* end = reinterpret_cast<const char*>(arr + first + count);
+        for (const char* line = begin; line < end; line += cache_line_size) {
+            prefetch(line);
         }
     }
+
+    /// Index of the greatest child (by predicate) of element with the first child at 'first'
+    template<size_t arity, typename T, typename Predicate>
+    size_t greatest_child(const T* arr, size_t size, size_t first, Predicate& pred) {
+        const size_t end = std::min(first + arity, size);
+        size_t greatest = first;
+        for (size_t child = first + 1; child < end; ++child) {
+            if (pred(arr[greatest], arr[child])) {
+                greatest = child;
+            }
+        }
+        return greatest;
+    }
+
+    /// Moves element at 'index' towards the root while it's greater than parent
+    template<size_t arity, typename T, typename Predicate>
+    void sift_up(T* arr, size_t index, Predicate& pred) {
+        T value = std::move(arr[index]);
+        while (index > 0) {
+            const size_t p = parent<arity>(index);
+            if (!pred(arr[p], value)) {
+                break;
+            }
+            arr[index] = std::move(arr[p]);
+            index = p;
+        }
+        arr[index] = std::move(value);
+    }
+
+    /// Places 'value' into the hole at 'hole' keeping the heap property of subtree.
+    /// Floyd's bottom-up method: the hole goes down to a leaf along the path of the greatest
+    /// children (one comparison per child), then value goes up from there.
+    /// It's cheaper than regular sift down because values taken from leaves rarely go up far.
+    template<size_t arity, typename T, typename Predicate>
+    void sift_hole_down(T* arr, size_t size, size_t hole, T value, Predicate& pred) {
+        const size_t top = hole;
+        for (size_t child = first_child<arity>(hole); child < size; child = first_child<arity>(hole)) {
+            prefetch_grandchildren<arity>(arr, size, hole);
+            const size_t greatest = greatest_child<arity>(arr, size, child, pred);
+            arr[hole] = std::move(arr[greatest]);
+            hole = greatest;
+        }
+
+        while (hole > top) {
+            const size_t p = parent<arity>(hole);
+            if (!pred(arr[p], value)) {
+                break;
+            }
+            arr[hole] = std::move(arr[p]);
+            hole = p;
+        }
+        arr[hole] = std::move(value);
+    }
+
+    template<size_t arity, typename T, typename Predicate>
+    void make_heap(T* arr, size_t size, Predicate& pred) {
+        if (size < 2) {
+            return;
+        }
+
+        for (size_t i = parent<arity>(size - 1) + 1; i > 0; --i) {
+            const size_t index = i - 1;
+            sift_hole_down<arity>(arr, size, index, std::move(arr[index]), pred);
+        }
+    }
+
+    /// Moves the greatest element to arr[size - 1] and restores heap of size - 1 elements
+    template<size_t arity, typename T, typename Predicate>
+    void pop_heap(T* arr, size_t size, Predicate& pred) {
+        if (size < 2) {
+            return;
+        }
+
+        const size_t last = size - 1;
+        T value = std::move(arr[last]);
+        arr[last] = std::move(arr[0]);
+        sift_hole_down<arity>(arr, last, 0, std::move(value), pred);
+    }
 }
 
 namespace sort
 {
-    template<typename T, typename Predicate = std::less<T>>
+    /// Iterative heap sort on d-ary heap ('arity' children per node).
+    /// Wider heaps are shallower and children of a node share cache lines.
+    template<typename T, typename Predicate = std::less<T>, size_t arity = 4>
     void heap_sort(T* arr, size_t size, Predicate&& pred = Predicate()) {
         using namespace heap_sort_impl;
-        const int n = static_cast<int>(size);
-
-        // Build heap (rearrange array) 
-        for (int i = n / 2 - 1; i >= 0; i--) {
-            heapify(arr, n, i, pred);
-        }
-
-        // One by one extract an element from heap 
-        for (int i = n - 1; i >= 0; i--) {
-            // Move current root to end 
-            std::swap(arr[0], arr[i]);
+        static_assert(arity >= 2, "Heap must have at least two children per node");
 
-            // call max heapify on the reduced heap 
-            heapify(arr, i, 0, pred);
+        make_heap<arity>(arr, size, pred);
+        for (size_t n = size; n > 1; --n) {
+            pop_heap<arity>(arr, n, pred);
         }
     }
 }
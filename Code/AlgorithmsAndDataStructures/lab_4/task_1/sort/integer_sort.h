@@ -0,0 +1,247 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "radix_sort.h"
+#include "scratch_arena.h"
+
+namespace sort
+{
+    struct integer_sort_options
+    {
+        /// Counting sort is used while keys range <= range_factor * size, radix sort otherwise
+        size_t range_factor = 4;
+
+        /// 0 - use all hardware threads
+        size_t threads_count = 0;
+
+        /// Smaller arrays are sorted by single thread
+        size_t parallel_threshold = size_t{ 1 } << 16;
+    };
+}
+
+namespace sort::integer_sort_impl
+{
+    constexpr size_t radix_bits = 8;
+    constexpr size_t radix = size_t{ 1 } << radix_bits;
+
+    /// Calls fn(thread_index, begin, end) for equal chunks of [0, size).
+    /// Chunks are the same for the same arguments: passes of one sort rely on it.
+    template<typename Fn>
+    void parallel_chunks(size_t threads_count, size_t size, Fn&& fn) {
+        if (threads_count < 2) {
+            fn(size_t{ 0 }, size_t{ 0 }, size);
+            return;
+        }
+
+        const size_t chunk = (size + threads_count - 1) / threads_count;
+        std::vector<std::thread> threads;
+        threads.reserve(threads_count - 1);
+        for (size_t t = 1; t < threads_count; ++t) {
+            const size_t begin = std::min(t * chunk, size);
+            const size_t end = std::min(begin + chunk, size);
+            threads.emplace_back([&fn, t, begin, end]() {
+                fn(t, begin, end);
+            });
+        }
+
+        fn(size_t{ 0 }, size_t{ 0 }, std::min(chunk, size));
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    inline size_t choose_threads_count(size_t size, const integer_sort_options& options) {
+        if (size < options.parallel_threshold) {
+            return 1;
+        }
+
+        if (options.threads_count != 0) {
+            return options.threads_count;
+        }
+
+        return std::max(size_t{ 1 }, static_cast<size_t>(std::thread::hardware_concurrency()));
+    }
+
+    template<typename T>
+    using key_t = std::make_unsigned_t<T>;
+
+    template<typename T>
+    void keys_min_max(const T* array, size_t size, size_t threads_count, key_t<T>& min, key_t<T>& max) {
+        using radix_sort_impl::to_unsigned_key;
+        std::vector<key_t<T>> mins(threads_count, std::numeric_limits<key_t<T>>::max());
+        std::vector<key_t<T>> maxs(threads_count, 0);
+        parallel_chunks(threads_count, size, [&](size_t t, size_t begin, size_t end) {
+            key_t<T> local_min = mins[t];
+            key_t<T> local_max = maxs[t];
+            for (size_t i = begin; i < end; ++i) {
+                const key_t<T> key = to_unsigned_key(array[i]);
+                local_min = std::min(local_min, key);
+                local_max = std::max(local_max, key);
+            }
+            mins[t] = local_min;
+            maxs[t] = local_max;
+        });
+
+        min = *std::min_element(mins.begin(), mins.end());
+        max = *std::max_element(maxs.begin(), maxs.end());
+    }
+
+    /// Count of histograms counting sort may use: one per thread while they all together
+    /// have no more counters than keys, fewer otherwise (down to a single histogram)
+    inline size_t counting_histograms_count(size_t size, size_t range, size_t threads_count) {
+        return std::clamp(size / range, size_t{ 1 }, threads_count);
+    }
+
+    /// Counting sort of keys in [min, min + range)
+    /// Chunks of array are counted in own histograms, then histograms are summed.
+    /// Histograms are limited by counting_histograms_count, so memory is O(max(range, size))
+    /// for any threads count
+    template<typename T>
+    void counting_sort_keys(T* array, size_t size, key_t<T> min, size_t range, size_t threads_count, scratch_arena& arena) {
+        using radix_sort_impl::to_unsigned_key;
+        const size_t histograms_count = counting_histograms_count(size, range, threads_count);
+        size_t* histograms = arena.allocate<size_t>(range * histograms_count);
+
+        parallel_chunks(histograms_count, size, [&](size_t t, size_t begin, size_t end) {
+            size_t* counts = histograms + t * range;
+            std::fill_n(counts, range, 0);
+            for (size_t i = begin; i < end; ++i) {
+                ++counts[static_cast<size_t>(to_unsigned_key(array[i]) - min)];
+            }
+        });
+
+        // Reduce to the first histogram
+        if (histograms_count > 1) {
+            parallel_chunks(threads_count, range, [&](size_t, size_t begin, size_t end) {
+                for (size_t t = 1; t < histograms_count; ++t) {
+                    const size_t* counts = histograms + t * range;
+                    for (size_t i = begin; i < end; ++i) {
+                        histograms[i] += counts[i];
+                    }
+                }
+            });
+        }
+
+        // Inclusive prefix sum: end offset of every key
+        size_t* ends = histograms;
+        for (size_t i = 1; i < range; ++i) {
+            ends[i] += ends[i - 1];
+        }
+
+        parallel_chunks(threads_count, range, [&](size_t, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const size_t first = i == 0 ? 0 : ends[i - 1];
+                const T value = radix_sort_impl::from_unsigned_key<T>(static_cast<key_t<T>>(min + i));
+                std::fill(array + first, array + ends[i], value);
+            }
+        });
+    }
+
+    /// LSD radix sort by bytes of (key - min)
+    /// Histograms and scatter of every pass are split between threads by chunks of array
+    template<typename T>
+    void radix_sort_keys(T* array, size_t size, key_t<T> min, key_t<T> span, size_t threads_count, scratch_arena& arena) {
+        using radix_sort_impl::to_unsigned_key;
+
+        size_t passes_count = 0;
+        for (key_t<T> rest = span; rest != 0; rest = static_cast<key_t<T>>(rest >> radix_bits)) {
+            ++passes_count;
+        }
+
+        T* buffer = arena.allocate<T>(size);
+        size_t* histograms = arena.allocate<size_t>(radix * threads_count);
+
+        T* source = array;
+        T* destination = buffer;
+        for (size_t pass = 0; pass < passes_count; ++pass) {
+            const size_t shift = pass * radix_bits;
+            auto digit = [&](const T value) {
+                return static_cast<size_t>((to_unsigned_key(value) - min) >> shift) & (radix - 1);
+            };
+
+            parallel_chunks(threads_count, size, [&](size_t t, size_t begin, size_t end) {
+                size_t* counts = histograms + t * radix;
+                std::fill_n(counts, radix, 0);
+                for (size_t i = begin; i < end; ++i) {
+                    ++counts[digit(source[i])];
+                }
+            });
+
+            // Offsets: buckets in order, threads in order inside of bucket (keeps sort stable)
+            bool single_bucket = false;
+            size_t offset = 0;
+            for (size_t d = 0; d < radix; ++d) {
+                const size_t bucket_begin = offset;
+                for (size_t t = 0; t < threads_count; ++t) {
+                    size_t& count = histograms[t * radix + d];
+                    const size_t thread_offset = offset;
+                    offset += count;
+                    count = thread_offset;
+                }
+                single_bucket = single_bucket || (offset - bucket_begin == size);
+            }
+
+            // This byte is the same for all keys
+            if (single_bucket) {
+                continue;
+            }
+
+            parallel_chunks(threads_count, size, [&](size_t t, size_t begin, size_t end) {
+                size_t* offsets = histograms + t * radix;
+                for (size_t i = begin; i < end; ++i) {
+                    destination[offsets[digit(source[i])]++] = source[i];
+                }
+            });
+
+            std::swap(source, destination);
+        }
+
+        if (source != array) {
+            std::copy_n(source, size, array);
+        }
+    }
+}
+
+namespace sort
+{
+    /// Sorts integers in ascending order:
+    /// counting sort if range of values is small compared to size, LSD radix sort otherwise.
+    /// Temporary arrays are taken from 'arena' (it's reset before return),
+    /// big arrays are counted and scattered by several threads.
+    template
+    <
+        typename T,
+        typename Enable = std::enable_if_t<std::is_integral_v<T>>
+    >
+    void integer_sort(T* array, size_t size, scratch_arena& arena, const integer_sort_options& options = {}) {
+        using namespace integer_sort_impl;
+
+        if (size < 2) {
+            return;
+        }
+
+        const size_t threads_count = choose_threads_count(size, options);
+        key_t<T> min;
+        key_t<T> max;
+        keys_min_max(array, size, threads_count, min, max);
+        const key_t<T> span = static_cast<key_t<T>>(max - min);
+        if (span == 0) {
+            return;
+        }
+
+        const bool small_range = options.range_factor != 0 && (span / options.range_factor) < size;
+        if (small_range) {
+            counting_sort_keys(array, size, min, static_cast<size_t>(span) + 1, threads_count, arena);
+        }
+        else {
+            radix_sort_keys(array, size, min, span, threads_count, arena);
+        }
+
+        arena.reset();
+    }
+}
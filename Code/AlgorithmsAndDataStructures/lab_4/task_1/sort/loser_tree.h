@@ -0,0 +1,108 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace sort
+{
+    /// Tournament tree of losers for k-way merging.
+    /// Every source exposes a pointer to its current value (nullptr when exhausted).
+    /// Replacing the winner costs log2(k) comparisons against stored losers only,
+    /// unlike heap which compares both children on each level.
+    /// Equal values are taken from the source with the smaller index, so merge is stable.
+    template<typename T, typename Predicate = std::less<T>>
+    class loser_tree
+    {
+    public:
+        loser_tree(size_t ways, Predicate predicate = Predicate()) :
+            m_values(ways, nullptr),
+            m_tree(std::max<size_t>(ways, 1), 0),
+            m_predicate(std::move(predicate))
+        {
+        }
+
+        size_t ways() const {
+            return m_values.size();
+        }
+
+        /// Sets current value of the source. Call build() after all sources are set
+        void reset(size_t source, const T* value) {
+            assert(source < ways());
+            m_values[source] = value;
+        }
+
+        void build() {
+            if (ways() != 0) {
+                m_tree[0] = build_node(1);
+            }
+        }
+
+        bool empty() const {
+            return ways() == 0 || m_values[m_tree[0]] == nullptr;
+        }
+
+        /// Index of the source holding the smallest value
+        size_t top_source() const {
+            assert(!empty());
+            return m_tree[0];
+        }
+
+        const T& top() const {
+            assert(!empty());
+            return *m_values[m_tree[0]];
+        }
+
+        /// Replaces value of the winner source with its next value (nullptr if exhausted)
+        void replace_top(const T* value) {
+            size_t winner = m_tree[0];
+            m_values[winner] = value;
+            for (size_t node = (winner + ways()) / 2; node > 0; node /= 2) {
+                if (beats(m_tree[node], winner)) {
+                    std::swap(m_tree[node], winner);
+                }
+            }
+            m_tree[0] = winner;
+        }
+
+    private:
+        bool beats(size_t a, size_t b) const {
+            const T* va = m_values[a];
+            const T* vb = m_values[b];
+            if (va == nullptr || vb == nullptr) {
+                return vb == nullptr && (va != nullptr || a < b);
+            }
+
+            if (m_predicate(*va, *vb)) {
+                return true;
+            }
+
+            return !m_predicate(*vb, *va) && a < b;
+        }
+
+        // Nodes are laid out as in binary heap: leaves are [ways, 2 * ways)
+        size_t build_node(size_t node) {
+            if (node >= ways()) {
+                return node - ways();
+            }
+
+            const size_t left = build_node(2 * node);
+            const size_t right = build_node(2 * node + 1);
+            if (beats(left, right)) {
+                m_tree[node] = right;
+                return left;
+            }
+
+            m_tree[node] = left;
+            return right;
+        }
+
+    private:
+        std::vector<const T*> m_values;
+        // m_tree[0] is the winner, other nodes keep losers
+        std::vector<size_t> m_tree;
+        Predicate m_predicate;
+    };
+}
@@ -1,9 +1,14 @@
 #pragma once
 
 #include <algorithm>
+#include <vector>
+
+#include "simd/sorting_network.h"
 
 namespace sort::merge_sort_impl
 {
+    // Blocks of this size are sorted by sorting network before merging (when available)
+    constexpr size_t network_block_size = 64;
     template<typename T, typename Predicate>
     void merge_sort_merge(T* a, T* b, size_t left, size_t right, size_t end, Predicate&& predicate) {
         size_t i = left;
@@ -26,11 +31,26 @@ namespace sort
     template<typename T, typename Predicate = std::less<T>>
     void merge_sort(T* arr, T* buff, size_t n, Predicate&& predicate = Predicate{}) {
         using namespace merge_sort_impl;
-        for (size_t width = 1; width < n; width *= 2) {
+        constexpr bool use_network = simd::is_network_sortable_v<T, Predicate>;
+
+        size_t width = 1;
+        if constexpr (use_network) {
+            width = network_block_size;
+            for (size_t i = 0; i < n; i += width) {
+                simd::sort_network(arr + i, std::min(width, n - i));
+            }
+        }
+
+        for (; width < n; width *= 2) {
             for (size_t i = 0; i < n; i += 2 * width) {
                 const size_t left = std::min(i + width, n);
                 const size_t right = std::min(i + 2 * width, n);
-                merge_sort_merge(arr, buff, i, left, right, predicate);
+                if constexpr (use_network) {
+                    simd::merge_sorted(arr + i, left - i, arr + left, right - left, buff + i);
+                }
+                else {
+                    merge_sort_merge(arr, buff, i, left, right, predicate);
+                }
             }
 
             for (size_t i = 0; i < n; ++i) {
@@ -38,4 +58,71 @@ namespace sort
             }
         }
     }
-}
+
+    /// Bottom-up merge sort of natural runs: non-descending runs are taken as is,
+    /// strictly descending runs are reversed. Presorted input needs few merge passes.
+    /// 'buff' must have space for n elements.
+    template<typename T, typename Predicate = std::less<T>>
+    void natural_merge_sort(T* arr, T* buff, size_t n, Predicate&& predicate = Predicate{}) {
+        using namespace merge_sort_impl;
+        constexpr bool use_network = simd::is_network_sortable_v<T, Predicate>;
+
+        if (n < 2) {
+            return;
+        }
+
+        // Begins of runs and 'n' as the end of the last one
+        std::vector<size_t> runs;
+        for (size_t i = 0; i < n;) {
+            runs.push_back(i);
+            size_t j = i + 1;
+            if (j < n && predicate(arr[j], arr[i])) {
+                while (j < n && predicate(arr[j], arr[j - 1])) {
+                    ++j;
+                }
+                std::reverse(arr + i, arr + j);
+            }
+            else {
+                while (j < n && !predicate(arr[j], arr[j - 1])) {
+                    ++j;
+                }
+            }
+            i = j;
+        }
+        runs.push_back(n);
+
+        T* source = arr;
+        T* destination = buff;
+        std::vector<size_t> merged_runs;
+        while (runs.size() > 2) {
+            merged_runs.clear();
+            size_t k = 0;
+            for (; k + 2 < runs.size(); k += 2) {
+                const size_t left = runs[k];
+                const size_t right = runs[k + 1];
+                const size_t end = runs[k + 2];
+                if constexpr (use_network) {
+                    simd::merge_sorted(source + left, right - left, source + right, end - right, destination + left);
+                }
+                else {
+                    merge_sort_merge(source, destination, left, right, end, predicate);
+                }
+                merged_runs.push_back(left);
+            }
+
+            // Odd run has no pair on this pass
+            if (k + 1 < runs.size()) {
+                std::copy(source + runs[k], source + n, destination + runs[k]);
+                merged_runs.push_back(runs[k]);
+            }
+
+            merged_runs.push_back(n);
+            runs.swap(merged_runs);
+            std::swap(source, destination);
+        }
+
+        if (source != arr) {
+            std::copy_n(source, n, arr);
+        }
+    }
+}
\ No newline at end of file
@@ -1,12 +1,22 @@
 #pragma once
 
 #include <algorithm>
+#include <cstddef>
+
+#include "heap_sort.h"
+#include "simd/sorting_network.h"
 
 namespace sort::quick_sort_impl
 {
+    // Partitions of this size or less are sorted by sorting network (when available)
+    constexpr std::ptrdiff_t network_threshold = 64;
+
+    // Partitions of this size or less are sorted by insertion sort in intro sort
+    constexpr size_t insertion_threshold = 16;
+
     template<typename T, typename Predicate>
-    T select_pivot(T* arr, int low, int high, Predicate& predicate) {
-        const int mid = (low + high) / 2;
+    T select_pivot(T* arr, std::ptrdiff_t low, std::ptrdiff_t high, Predicate& predicate) {
+        const std::ptrdiff_t mid = (low + high) / 2;
 
         if (predicate(arr[mid], arr[low])) {
             std::swap(arr[mid], arr[low]);
@@ -24,10 +34,10 @@ namespace sort::quick_sort_impl
     }
 
     template<typename T, typename Predicate>
-    int hoare_partition(T* arr, int low, int high, Predicate& predicate) {
+    std::ptrdiff_t hoare_partition(T* arr, std::ptrdiff_t low, std::ptrdiff_t high, Predicate& predicate) {
         const T pivot = select_pivot(arr, low, high, predicate);
-        int i = low - 1;
-        int j = high + 1;
+        std::ptrdiff_t i = low - 1;
+        std::ptrdiff_t j = high + 1;
         while (true) {
             while (predicate(arr[++i], pivot));
             while (predicate(pivot, arr[--j]));
@@ -40,19 +50,126 @@ namespace sort::quick_sort_impl
     }
 
     template<typename T, typename Predicate>
-    void quick_sort_impl(T* array, int low, int high, Predicate& predicate) {
+    void quick_sort_impl(T* array, std::ptrdiff_t low, std::ptrdiff_t high, Predicate& predicate) {
+        if constexpr (simd::is_network_sortable_v<T, Predicate>) {
+            const std::ptrdiff_t size = high - low + 1;
+            if (size <= network_threshold) {
+                if (size > 1) {
+                    simd::sort_network(array + low, static_cast<size_t>(size));
+                }
+                return;
+            }
+        }
+
         if (low < high) {
-            int p = hoare_partition(array, low, high, predicate);
+            const std::ptrdiff_t p = hoare_partition(array, low, high, predicate);
             quick_sort_impl(array, low, p, predicate);
             quick_sort_impl(array, p + 1, high, predicate);
         }
     }
 }
 
+namespace sort::quick_sort_impl
+{
+    template<typename T, typename Predicate>
+    void insertion_sort(T* array, size_t size, Predicate& predicate) {
+        for (size_t i = 1; i < size; ++i) {
+            T value = std::move(array[i]);
+            size_t j = i;
+            for (; j > 0 && predicate(value, array[j - 1]); --j) {
+                array[j] = std::move(array[j - 1]);
+            }
+            array[j] = std::move(value);
+        }
+    }
+
+    /// Hoare partition of array (size >= 2) around median of the first, middle and last elements
+    /// Returns size of the first part: [0, result) <= pivot <= [result, size)
+    template<typename T, typename Predicate>
+    size_t hoare_partition_median(T* array, size_t size, Predicate& predicate) {
+        const size_t last = size - 1;
+        const size_t mid = last / 2;
+        if (predicate(array[mid], array[0])) {
+            std::swap(array[mid], array[0]);
+        }
+        if (predicate(array[last], array[mid])) {
+            std::swap(array[last], array[mid]);
+            if (predicate(array[mid], array[0])) {
+                std::swap(array[mid], array[0]);
+            }
+        }
+
+        // Ends of array are sentinels for the inner loops
+        const T pivot = array[mid];
+        size_t i = 0;
+        size_t j = last;
+        while (true) {
+            while (predicate(array[i], pivot)) {
+                ++i;
+            }
+            while (predicate(pivot, array[j])) {
+                --j;
+            }
+            if (i >= j) {
+                return j + 1;
+            }
+            std::swap(array[i], array[j]);
+            ++i;
+            --j;
+        }
+    }
+
+    template<typename T, typename Predicate>
+    void intro_sort_loop(T* array, size_t size, size_t depth_limit, Predicate& predicate) {
+        constexpr bool use_network = simd::is_network_sortable_v<T, Predicate>;
+        constexpr size_t small_size = use_network ? static_cast<size_t>(network_threshold) : insertion_threshold;
+
+        while (size > small_size) {
+            if (depth_limit == 0) {
+                // Too many bad pivots: guarantee n log n
+                heap_sort<T, Predicate&>(array, size, predicate);
+                return;
+            }
+            --depth_limit;
+
+            const size_t split = hoare_partition_median(array, size, predicate);
+
+            // Recursion for the smaller part keeps stack depth logarithmic
+            if (split < size - split) {
+                intro_sort_loop(array, split, depth_limit, predicate);
+                array += split;
+                size -= split;
+            }
+            else {
+                intro_sort_loop(array + split, size - split, depth_limit, predicate);
+                size = split;
+            }
+        }
+
+        if constexpr (use_network) {
+            simd::sort_network(array, size);
+        }
+        else {
+            insertion_sort(array, size, predicate);
+        }
+    }
+}
+
 namespace sort
 {
+    /// Quick sort with depth limit (heap sort fallback) and small partitions sorted
+    /// by sorting network or insertion sort
+    template<typename T, typename Predicate = std::less<T>>
+    void intro_sort(T* array, size_t size, Predicate predicate = Predicate()) {
+        size_t depth_limit = 0;
+        for (size_t n = size; n > 1; n /= 2) {
+            depth_limit += 2;
+        }
+        quick_sort_impl::intro_sort_loop(array, size, depth_limit, predicate);
+    }
+
     template<typename T, typename Predicate = std::less<T>>
     void quick_sort(T* array, size_t size, Predicate predicate = Predicate()) {
-        quick_sort_impl::quick_sort_impl(array, 0, static_cast<int>(size) - 1, predicate);
+        quick_sort_impl::quick_sort_impl(array, 0, static_cast<std::ptrdiff_t>(size) - 1, predicate);
     }
 }
@@ -1,7 +1,11 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
 #include <type_traits>
+#include <vector>
 
 namespace sort::radix_sort_impl
 {
@@ -96,6 +100,139 @@ namespace sort::radix_sort_impl
         }
         return msbi;
     }
+
+    // American flag sort splits array in 256 buckets per pass (one byte of key)
+    constexpr size_t american_flag_radix = 256;
+
+    // Buckets smaller than this are sorted by insertion sort
+    constexpr size_t american_flag_insertion_threshold = 32;
+
+    // Converts value to unsigned key with the same order
+    // (sign bit is flipped for signed types)
+    template<typename element_type>
+    constexpr std::make_unsigned_t<element_type> to_unsigned_key(const element_type value) {
+        using key_type = std::make_unsigned_t<element_type>;
+        key_type key = static_cast<key_type>(value);
+        if constexpr (std::is_signed_v<element_type>) {
+            key ^= key_type{ 1 } << (sizeof(key_type) * 8 - 1);
+        }
+        return key;
+    }
+
+    /// Inverse of to_unsigned_key
+    template<typename element_type>
+    constexpr element_type from_unsigned_key(std::make_unsigned_t<element_type> key) {
+        using key_type = std::make_unsigned_t<element_type>;
+        if constexpr (std::is_signed_v<element_type>) {
+            key ^= key_type{ 1 } << (sizeof(key_type) * 8 - 1);
+        }
+        return static_cast<element_type>(key);
+    }
+
+    template<bool ascending, typename element_type>
+    constexpr size_t byte_digit(const element_type value, const size_t byte_index) {
+        const size_t digit = static_cast<size_t>((to_unsigned_key(value) >> (byte_index * 8)) & 0xFF);
+        if constexpr (ascending) {
+            return digit;
+        }
+        else {
+            return american_flag_radix - 1 - digit;
+        }
+    }
+
+    template<bool ascending, typename element_type>
+    void insertion_sort(element_type* array, size_t size) {
+        for (size_t i = 1; i < size; ++i) {
+            const element_type value = array[i];
+            size_t j = i;
+            for (; j > 0; --j) {
+                const bool in_order = ascending ? !(value < array[j - 1]) : !(array[j - 1] < value);
+                if (in_order) {
+                    break;
+                }
+                array[j] = array[j - 1];
+            }
+            array[j] = value;
+        }
+    }
+
+    // Index of the most significant byte that differs between array elements
+    // Returns false if all elements are equal
+    template<typename element_type>
+    bool highest_differing_byte(const element_type* array, size_t size, size_t& byte_index) {
+        using key_type = std::make_unsigned_t<element_type>;
+        const key_type first = to_unsigned_key(array[0]);
+        key_type diff = 0;
+        for (size_t i = 1; i < size; ++i) {
+            diff |= to_unsigned_key(array[i]) ^ first;
+        }
+
+        if (diff == 0) {
+            return false;
+        }
+
+        byte_index = 0;
+        while ((diff >> 8) != 0) {
+            diff >>= 8;
+            ++byte_index;
+        }
+        return true;
+    }
+
+    // In-place partitioning of array by byte at byte_index
+    // Writes buckets begin offsets to 'bucket_begin' (radix + 1 values)
+    template<bool ascending, typename element_type>
+    void american_flag_partition(element_type* array, size_t size, size_t byte_index, size_t* bucket_begin) {
+        size_t counts[american_flag_radix]{};
+        for (size_t i = 0; i < size; ++i) {
+            ++counts[byte_digit<ascending>(array[i], byte_index)];
+        }
+
+        size_t heads[american_flag_radix];
+        size_t offset = 0;
+        for (size_t bucket = 0; bucket < american_flag_radix; ++bucket) {
+            bucket_begin[bucket] = offset;
+            heads[bucket] = offset;
+            offset += counts[bucket];
+        }
+        bucket_begin[american_flag_radix] = offset;
+
+        // Move every element to its bucket following permutation cycles
+        for (size_t bucket = 0; bucket < american_flag_radix; ++bucket) {
+            const size_t bucket_end = bucket_begin[bucket + 1];
+            while (heads[bucket] < bucket_end) {
+                element_type value = array[heads[bucket]];
+                size_t digit = byte_digit<ascending>(value, byte_index);
+                while (digit != bucket) {
+                    std::swap(value, array[heads[digit]++]);
+                    digit = byte_digit<ascending>(value, byte_index);
+                }
+                array[heads[bucket]++] = value;
+            }
+        }
+    }
+
+    template<bool ascending, typename element_type>
+    void american_flag_sort_at(element_type* array, size_t size, size_t byte_index) {
+        if (size <= american_flag_insertion_threshold) {
+            insertion_sort<ascending>(array, size);
+            return;
+        }
+
+        size_t bucket_begin[american_flag_radix + 1];
+        american_flag_partition<ascending>(array, size, byte_index, bucket_begin);
+
+        if (byte_index == 0) {
+            return;
+        }
+
+        for (size_t bucket = 0; bucket < american_flag_radix; ++bucket) {
+            const size_t bucket_size = bucket_begin[bucket + 1] - bucket_begin[bucket];
+            if (bucket_size > 1) {
+                american_flag_sort_at<ascending>(array + bucket_begin[bucket], bucket_size, byte_index - 1);
+            }
+        }
+    }
 }
 
 namespace sort
@@ -166,4 +303,58 @@ namespace sort
             }
         }
     }
-}
+
+    /// In-place MSD radix sort over 256-way buckets (American flag sort)
+    /// Skips leading bytes that are equal for all elements
+    /// and sorts small buckets by insertion sort.
+    /// If 'parallel' is set buckets of the first level are sorted by several threads
+    template
+    <
+        typename element_type,
+        bool ascending = true,
+        typename enable = std::enable_if_t<std::is_integral_v<element_type> && !std::is_same_v<element_type, bool>>
+    >
+    void radix_sort_american_flag(element_type* array, size_t size, bool parallel = false) {
+        using namespace radix_sort_impl;
+
+        if (size <= american_flag_insertion_threshold) {
+            insertion_sort<ascending>(array, size);
+            return;
+        }
+
+        size_t byte_index = 0;
+        if (!highest_differing_byte(array, size, byte_index)) {
+            return;
+        }
+
+        const size_t threads_count = parallel ? std::thread::hardware_concurrency() : 1;
+        if (threads_count < 2 || byte_index == 0) {
+            american_flag_sort_at<ascending>(array, size, byte_index);
+            return;
+        }
+
+        size_t bucket_begin[american_flag_radix + 1];
+        american_flag_partition<ascending>(array, size, byte_index, bucket_begin);
+
+        // Buckets are independent so workers just take the next unsorted one
+        std::atomic<size_t> next_bucket = 0;
+        auto worker = [&]() {
+            for (size_t bucket = next_bucket++; bucket < american_flag_radix; bucket = next_bucket++) {
+                const size_t bucket_size = bucket_begin[bucket + 1] - bucket_begin[bucket];
+                if (bucket_size > 1) {
+                    american_flag_sort_at<ascending>(array + bucket_begin[bucket], bucket_size, byte_index - 1);
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(threads_count - 1);
+        for (size_t i = 1; i < threads_count; ++i) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+}
\ No newline at end of file
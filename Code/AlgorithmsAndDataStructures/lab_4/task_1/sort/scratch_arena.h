@@ -0,0 +1,86 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace sort
+{
+    /// Bump allocator for temporary arrays of sorting algorithms.
+    /// Memory is returned to arena by reset() and reused by the next sort,
+    /// so repeated sorts do not allocate once arena has grown to the working size.
+    class scratch_arena
+    {
+    private:
+        struct block
+        {
+            std::unique_ptr<std::byte[]> data;
+            size_t size = 0;
+        };
+
+    public:
+        /// Returns uninitialized storage for 'count' objects of trivial type T
+        /// Pointers stay valid until reset()
+        template<typename T>
+        T* allocate(size_t count) {
+            static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>);
+            const size_t bytes = count * sizeof(T);
+            const size_t alignment = alignof(std::max_align_t);
+
+            if (!m_blocks.empty()) {
+                block& current = m_blocks.back();
+                const size_t offset = align_up(m_offset, alignment);
+                if (offset + bytes <= current.size) {
+                    m_offset = offset + bytes;
+                    return reinterpret_cast<T*>(current.data.get() + offset);
+                }
+            }
+
+            // Previous blocks must stay alive: their memory may be in use
+            const size_t block_size = std::max(bytes, m_capacity);
+            add_block(block_size);
+            m_offset = bytes;
+            return reinterpret_cast<T*>(m_blocks.back().data.get());
+        }
+
+        /// Releases all allocations.
+        /// If arena had to grow it's merged in one block big enough for the same workload
+        void reset() {
+            if (m_blocks.size() > 1) {
+                size_t total = 0;
+                for (const block& b : m_blocks) {
+                    total += b.size;
+                }
+                m_blocks.clear();
+                m_capacity = 0;
+                add_block(total);
+            }
+            m_offset = 0;
+        }
+
+        /// Total bytes owned by arena
+        size_t capacity() const {
+            return m_capacity;
+        }
+
+    private:
+        static size_t align_up(size_t value, size_t alignment) {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+
+        void add_block(size_t size) {
+            block b;
+            b.data.reset(new std::byte[size]);
+            b.size = size;
+            m_capacity += size;
+            m_blocks.push_back(std::move(b));
+        }
+
+    private:
+        std::vector<block> m_blocks;
+        size_t m_offset = 0;
+        size_t m_capacity = 0;
+    };
+}
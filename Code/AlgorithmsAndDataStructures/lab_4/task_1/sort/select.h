@@ -0,0 +1,188 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "heap.h"
+#include "quick_sort.h"
+
+namespace sort::select_impl
+{
+    // Median of groups of this size gives linear worst case
+    constexpr size_t group_size = 5;
+
+    /// Three-way partition around pivot value
+    /// Returns [lt, gt): [0, lt) < pivot, [lt, gt) == pivot, [gt, size) > pivot
+    template<typename T, typename Predicate>
+    std::pair<size_t, size_t> partition_three_way(T* array, size_t size, const T& pivot, Predicate& predicate) {
+        size_t lt = 0;
+        size_t i = 0;
+        size_t gt = size;
+        while (i < gt) {
+            if (predicate(array[i], pivot)) {
+                std::swap(array[lt++], array[i++]);
+            }
+            else if (predicate(pivot, array[i])) {
+                std::swap(array[i], array[--gt]);
+            }
+            else {
+                ++i;
+            }
+        }
+        return { lt, gt };
+    }
+
+    template<typename T, typename Predicate>
+    void median_of_medians_select(T* array, size_t size, size_t nth, Predicate& predicate);
+
+    /// Pivot that has at least 3/10 of elements on each side.
+    /// Medians of groups are gathered at the beginning of array
+    template<typename T, typename Predicate>
+    T median_of_medians_pivot(T* array, size_t size, Predicate& predicate) {
+        size_t medians_count = 0;
+        for (size_t i = 0; i < size; i += group_size) {
+            const size_t n = std::min(group_size, size - i);
+            quick_sort_impl::insertion_sort(array + i, n, predicate);
+            std::swap(array[medians_count++], array[i + n / 2]);
+        }
+
+        median_of_medians_select(array, medians_count, medians_count / 2, predicate);
+        return array[medians_count / 2];
+    }
+
+    /// Deterministic linear selection (Blum, Floyd, Pratt, Rivest, Tarjan)
+    template<typename T, typename Predicate>
+    void median_of_medians_select(T* array, size_t size, size_t nth, Predicate& predicate) {
+        while (size > quick_sort_impl::insertion_threshold) {
+            const T pivot = median_of_medians_pivot(array, size, predicate);
+            const auto [lt, gt] = partition_three_way(array, size, pivot, predicate);
+            if (nth < lt) {
+                size = lt;
+            }
+            else if (nth >= gt) {
+                array += gt;
+                size -= gt;
+                nth -= gt;
+            }
+            else {
+                return;
+            }
+        }
+
+        quick_sort_impl::insertion_sort(array, size, predicate);
+    }
+
+    /// Quick select on median of three partitions.
+    /// When depth limit is exhausted the rest is done by median of medians
+    template<typename T, typename Predicate>
+    void intro_select_loop(T* array, size_t size, size_t nth, size_t depth_limit, Predicate& predicate) {
+        while (size > quick_sort_impl::insertion_threshold) {
+            if (depth_limit == 0) {
+                median_of_medians_select(array, size, nth, predicate);
+                return;
+            }
+            --depth_limit;
+
+            const size_t split = quick_sort_impl::hoare_partition_median(array, size, predicate);
+            if (nth < split) {
+                size = split;
+            }
+            else {
+                array += split;
+                size -= split;
+                nth -= split;
+            }
+        }
+
+        quick_sort_impl::insertion_sort(array, size, predicate);
+    }
+}
+
+namespace sort
+{
+    /// Places the element that would be at 'nth' position of sorted array there,
+    /// elements before it are not greater and elements after it are not less.
+    /// Introselect: expected linear time, median of medians fallback bounds the worst case
+    template<typename T, typename Predicate = std::less<T>>
+    void nth_element(T* array, size_t size, size_t nth, Predicate predicate = Predicate()) {
+        if (nth >= size) {
+            return;
+        }
+
+        size_t depth_limit = 0;
+        for (size_t n = size; n > 1; n /= 2) {
+            depth_limit += 2;
+        }
+        select_impl::intro_select_loop(array, size, nth, depth_limit, predicate);
+    }
+
+    /// Sorts the first k elements of array, the rest are left in unspecified order.
+    /// Selection followed by sort of the front part: O(n + k log k)
+    template<typename T, typename Predicate = std::less<T>>
+    void partial_sort(T* array, size_t size, size_t k, Predicate predicate = Predicate()) {
+        k = std::min(k, size);
+        if (k == 0) {
+            return;
+        }
+
+        if (k < size) {
+            sort::nth_element(array, size, k - 1, predicate);
+        }
+        sort::intro_sort(array, k, predicate);
+    }
+
+    /// Keeps the k smallest elements (by predicate) of a stream in O(k) memory.
+    /// Stored elements form a heap with the greatest kept element on top,
+    /// so each new element is compared with it once and replaces it when smaller
+    template<typename T, typename Predicate = std::less<T>, size_t arity = 4>
+    class top_k
+    {
+    public:
+        top_k(size_t k, Predicate predicate = Predicate()) :
+            m_heap(predicate),
+            m_predicate(std::move(predicate)),
+            m_k(k)
+        {
+            m_heap.reserve(k);
+        }
+
+        size_t size() const {
+            return m_heap.size();
+        }
+
+        /// The greatest kept element: new ones must be less to be kept
+        const T& threshold() const {
+            return m_heap.top();
+        }
+
+        void push(const T& value) {
+            if (m_heap.size() < m_k) {
+                m_heap.push(value);
+            }
+            else if (m_k != 0 && m_predicate(value, m_heap.top())) {
+                m_heap.replace_top(value);
+            }
+        }
+
+        void push(const T* values, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                push(values[i]);
+            }
+        }
+
+        /// Kept elements in ascending order, the selector is left empty
+        std::vector<T> take_sorted() {
+            std::vector<T> result = m_heap.take_sorted();
+            m_heap.clear();
+            return result;
+        }
+
+    private:
+        heap<T, Predicate, arity> m_heap;
+        Predicate m_predicate;
+        size_t m_k;
+    };
+}
@@ -0,0 +1,308 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+
+#include "simd/set_intersection.h"
+
+namespace sort::set_operations_impl
+{
+    // When one input is this many times longer than the other, elements of the shorter one
+    // are searched in the longer one: O(small * log(large / small)) instead of O(small + large)
+    constexpr size_t galloping_ratio = 32;
+
+    inline bool is_skewed(size_t a_size, size_t b_size) {
+        return std::min(a_size, b_size) * galloping_ratio < std::max(a_size, b_size);
+    }
+
+    /// The first position in [from, size) whose element is not less than 'value'.
+    /// Exponential search from 'from' followed by binary search in the last step:
+    /// O(log d) where d is the distance to the result
+    template<typename T, typename Predicate>
+    size_t gallop_lower_bound(const T* array, size_t from, size_t size, const T& value, Predicate& predicate) {
+        size_t low = from;
+        size_t high = from;
+        size_t step = 1;
+        while (high < size && predicate(array[high], value)) {
+            low = high + 1;
+            high += step;
+            step *= 2;
+        }
+
+        high = std::min(high, size);
+        return static_cast<size_t>(std::lower_bound(array + low, array + high, value, predicate) - array);
+    }
+
+    /// Advances past elements less than 'value': linear scan or galloping
+    template<bool galloping, typename T, typename Predicate>
+    size_t skip_less(const T* array, size_t from, size_t size, const T& value, Predicate& predicate) {
+        if constexpr (galloping) {
+            return gallop_lower_bound(array, from, size, value, predicate);
+        }
+        else {
+            while (from < size && predicate(array[from], value)) {
+                ++from;
+            }
+            return from;
+        }
+    }
+
+    template<typename T, typename Predicate>
+    size_t intersect_merge(const T* a, size_t a_size, const T* b, size_t b_size, T* out, Predicate& predicate) {
+        size_t i = 0;
+        size_t j = 0;
+        size_t count = 0;
+        while (i < a_size && j < b_size) {
+            if (predicate(a[i], b[j])) {
+                ++i;
+            }
+            else if (predicate(b[j], a[i])) {
+                ++j;
+            }
+            else {
+                out[count++] = a[i];
+                ++i;
+                ++j;
+            }
+        }
+        return count;
+    }
+
+    /// Every element of the shorter input is searched in the longer one
+    template<typename T, typename Predicate>
+    size_t intersect_galloping(const T* a, size_t a_size, const T* b, size_t b_size, T* out, Predicate& predicate) {
+        const bool a_shorter = a_size <= b_size;
+        const T* small = a_shorter ? a : b;
+        const T* large = a_shorter ? b : a;
+        const size_t small_size = a_shorter ? a_size : b_size;
+        const size_t large_size = a_shorter ? b_size : a_size;
+
+        size_t position = 0;
+        size_t count = 0;
+        for (size_t i = 0; i < small_size; ++i) {
+            position = gallop_lower_bound(large, position, large_size, small[i], predicate);
+            if (position == large_size) {
+                break;
+            }
+
+            if (!predicate(small[i], large[position])) {
+                // Elements are taken from 'a' as std::set_intersection does
+                out[count++] = a_shorter ? small[i] : large[position];
+                ++position;
+            }
+        }
+        return count;
+    }
+
+    template<typename T, typename Predicate>
+    size_t union_merge(const T* a, size_t a_size, const T* b, size_t b_size, T* out, Predicate& predicate) {
+        size_t i = 0;
+        size_t j = 0;
+        size_t count = 0;
+        while (i < a_size && j < b_size) {
+            if (predicate(b[j], a[i])) {
+                out[count++] = b[j++];
+            }
+            else {
+                if (!predicate(a[i], b[j])) {
+                    ++j;
+                }
+                out[count++] = a[i++];
+            }
+        }
+
+        out = std::copy(a + i, a + a_size, out + count);
+        std::copy(b + j, b + b_size, out);
+        return count + (a_size - i) + (b_size - j);
+    }
+
+    /// Ranges of the longer input between elements of the shorter one are copied as a whole
+    template<typename T, typename Predicate>
+    size_t union_galloping(const T* a, size_t a_size, const T* b, size_t b_size, T* out, Predicate& predicate) {
+        const bool a_shorter = a_size <= b_size;
+        const T* small = a_shorter ? a : b;
+        const T* large = a_shorter ? b : a;
+        const size_t small_size = a_shorter ? a_size : b_size;
+        const size_t large_size = a_shorter ? b_size : a_size;
+
+        T* const first = out;
+        size_t position = 0;
+        for (size_t i = 0; i < small_size; ++i) {
+            const size_t next = gallop_lower_bound(large, position, large_size, small[i], predicate);
+            out = std::copy(large + position, large + next, out);
+            position = next;
+
+            if (position < large_size && !predicate(small[i], large[position])) {
+                *out++ = a_shorter ? small[i] : large[position];
+                ++position;
+            }
+            else {
+                *out++ = small[i];
+            }
+        }
+
+        out = std::copy(large + position, large + large_size, out);
+        return static_cast<size_t>(out - first);
+    }
+
+    template<typename T, typename Predicate>
+    size_t difference_merge(const T* a, size_t a_size, const T* b, size_t b_size, T* out, Predicate& predicate) {
+        size_t i = 0;
+        size_t j = 0;
+        size_t count = 0;
+        while (i < a_size && j < b_size) {
+            if (predicate(a[i], b[j])) {
+                out[count++] = a[i++];
+            }
+            else {
+                if (!predicate(b[j], a[i])) {
+                    ++i;
+                }
+                ++j;
+            }
+        }
+
+        std::copy(a + i, a + a_size, out + count);
+        return count + (a_size - i);
+    }
+
+    template<typename T, typename Predicate>
+    size_t difference_galloping(const T* a, size_t a_size, const T* b, size_t b_size, T* out, Predicate& predicate) {
+        T* const first = out;
+        if (a_size <= b_size) {
+            // Elements of 'a' that are not found in 'b'
+            size_t position = 0;
+            for (size_t i = 0; i < a_size; ++i) {
+                position = gallop_lower_bound(b, position, b_size, a[i], predicate);
+                if (position == b_size || predicate(a[i], b[position])) {
+                    *out++ = a[i];
+                }
+            }
+        }
+        else {
+            // Ranges of 'a' between elements of 'b'
+            size_t position = 0;
+            for (size_t j = 0; j < b_size; ++j) {
+                const size_t next = gallop_lower_bound(a, position, a_size, b[j], predicate);
+                out = std::copy(a + position, a + next, out);
+                position = next;
+                if (position < a_size && !predicate(b[j], a[position])) {
+                    ++position;
+                }
+            }
+            out = std::copy(a + position, a + a_size, out);
+        }
+        return static_cast<size_t>(out - first);
+    }
+
+    template<bool galloping, typename Key, typename LeftValue, typename RightValue, typename Emit, typename Predicate>
+    size_t merge_join_loop(
+        const Key* left_keys, const LeftValue* left_values, size_t left_size,
+        const Key* right_keys, const RightValue* right_values, size_t right_size,
+        Emit& emit, Predicate& predicate)
+    {
+        size_t i = 0;
+        size_t j = 0;
+        size_t count = 0;
+        while (i < left_size && j < right_size) {
+            if (predicate(left_keys[i], right_keys[j])) {
+                i = skip_less<galloping>(left_keys, i + 1, left_size, right_keys[j], predicate);
+            }
+            else if (predicate(right_keys[j], left_keys[i])) {
+                j = skip_less<galloping>(right_keys, j + 1, right_size, left_keys[i], predicate);
+            }
+            else {
+                // Groups of equivalent keys are joined all to all
+                const Key& key = left_keys[i];
+                size_t left_end = i + 1;
+                while (left_end < left_size && !predicate(key, left_keys[left_end])) {
+                    ++left_end;
+                }
+                size_t right_end = j + 1;
+                while (right_end < right_size && !predicate(key, right_keys[right_end])) {
+                    ++right_end;
+                }
+
+                for (size_t l = i; l < left_end; ++l) {
+                    for (size_t r = j; r < right_end; ++r) {
+                        emit(left_keys[l], left_values[l], right_values[r]);
+                    }
+                }
+                count += (left_end - i) * (right_end - j);
+                i = left_end;
+                j = right_end;
+            }
+        }
+        return count;
+    }
+}
+
+// Operations on sets stored as sorted arrays: elements are strictly increasing by predicate.
+// Every operation writes its result to 'out' (which must not overlap inputs) in sorted order
+// and returns the number of written elements.
+// Inputs of similar sizes are merged linearly, when one is much shorter its elements
+// are searched in the other one by galloping, so cost follows the shorter input.
+namespace sort
+{
+    /// Elements found in both sets. 'out' must have space for min(a_size, b_size) elements.
+    /// 32-bit integer keys ordered by std::less are compared by blocks with vector instructions
+    template<typename T, typename Predicate = std::less<T>>
+    size_t sorted_intersect(const T* a, size_t a_size, const T* b, size_t b_size, T* out, Predicate predicate = Predicate()) {
+        using namespace set_operations_impl;
+        if (is_skewed(a_size, b_size)) {
+            return intersect_galloping(a, a_size, b, b_size, out, predicate);
+        }
+
+        if constexpr (simd::is_set_intersectable_v<T, Predicate>) {
+            return simd::intersect_sorted(a, a_size, b, b_size, out);
+        }
+        else {
+            return intersect_merge(a, a_size, b, b_size, out, predicate);
+        }
+    }
+
+    /// Elements found in any of sets. 'out' must have space for a_size + b_size elements
+    template<typename T, typename Predicate = std::less<T>>
+    size_t sorted_union(const T* a, size_t a_size, const T* b, size_t b_size, T* out, Predicate predicate = Predicate()) {
+        using namespace set_operations_impl;
+        if (is_skewed(a_size, b_size)) {
+            return union_galloping(a, a_size, b, b_size, out, predicate);
+        }
+        return union_merge(a, a_size, b, b_size, out, predicate);
+    }
+
+    /// Elements of 'a' not found in 'b'. 'out' must have space for a_size elements
+    template<typename T, typename Predicate = std::less<T>>
+    size_t sorted_difference(const T* a, size_t a_size, const T* b, size_t b_size, T* out, Predicate predicate = Predicate()) {
+        using namespace set_operations_impl;
+        if (is_skewed(a_size, b_size)) {
+            return difference_galloping(a, a_size, b, b_size, out, predicate);
+        }
+        return difference_merge(a, a_size, b, b_size, out, predicate);
+    }
+
+    /// Inner join of two key/value arrays sorted by keys (keys may repeat, e.g. after sort_by_key).
+    /// Calls emit(key, left_value, right_value) for every pair of entries with equivalent keys,
+    /// in order of keys, then left entries, then right entries. Returns number of emitted pairs.
+    /// When one side is much shorter, runs of unmatched keys of the other side are skipped by galloping
+    template
+    <
+        typename Key,
+        typename LeftValue,
+        typename RightValue,
+        typename Emit,
+        typename Predicate = std::less<Key>
+    >
+    size_t merge_join(
+        const Key* left_keys, const LeftValue* left_values, size_t left_size,
+        const Key* right_keys, const RightValue* right_values, size_t right_size,
+        Emit&& emit, Predicate predicate = Predicate())
+    {
+        using namespace set_operations_impl;
+        if (is_skewed(left_size, right_size)) {
+            return merge_join_loop<true>(left_keys, left_values, left_size, right_keys, right_values, right_size, emit, predicate);
+        }
+        return merge_join_loop<false>(left_keys, left_values, left_size, right_keys, right_values, right_size, emit, predicate);
+    }
+}
@@ -0,0 +1,39 @@
+#include "set_intersection.h"
+
+namespace sort::simd::detail
+{
+#if !SORT_SIMD_X86
+    // Vector kernels exist only for x86, other platforms are served by scalar ones
+    size_t intersect_sorted_sse42(const int32_t*, size_t, const int32_t*, size_t, int32_t*) {
+        return 0;
+    }
+
+    size_t intersect_sorted_sse42(const uint32_t*, size_t, const uint32_t*, size_t, uint32_t*) {
+        return 0;
+    }
+#endif
+
+    namespace
+    {
+        template<typename T>
+        size_t intersect_sorted_dispatch(const T* a, size_t a_size, const T* b, size_t b_size, T* out) {
+            // Block comparison is 4 lanes wide: AVX2 would need 8 permutations for 8 lanes
+            // and gives no gain on typical intersection sizes, so it uses SSE kernel
+            if (active_isa() != isa::scalar) {
+                return intersect_sorted_sse42(a, a_size, b, b_size, out);
+            }
+            return intersect_scalar(a, a_size, b, b_size, out);
+        }
+    }
+}
+
+namespace sort::simd
+{
+    size_t intersect_sorted(const int32_t* a, size_t a_size, const int32_t* b, size_t b_size, int32_t* out) {
+        return detail::intersect_sorted_dispatch(a, a_size, b, b_size, out);
+    }
+
+    size_t intersect_sorted(const uint32_t* a, size_t a_size, const uint32_t* b, size_t b_size, uint32_t* out) {
+        return detail::intersect_sorted_dispatch(a, a_size, b, b_size, out);
+    }
+}
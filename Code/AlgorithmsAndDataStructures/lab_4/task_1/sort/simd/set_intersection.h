@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+
+#include "sorting_network.h"
+
+namespace sort::simd
+{
+    /// Intersection of two strictly increasing arrays (sets), returns number of elements written to 'out'.
+    /// 'out' must have space for min(a_size, b_size) elements and may be equal to 'a'
+    size_t intersect_sorted(const int32_t* a, size_t a_size, const int32_t* b, size_t b_size, int32_t* out);
+    size_t intersect_sorted(const uint32_t* a, size_t a_size, const uint32_t* b, size_t b_size, uint32_t* out);
+
+    template<typename T>
+    constexpr bool is_set_key_v =
+        std::is_same_v<T, int32_t> ||
+        std::is_same_v<T, uint32_t>;
+
+    /// True if sort::sorted_intersect<T, Predicate> may use vector kernels
+    template<typename T, typename Predicate>
+    constexpr bool is_set_intersectable_v =
+        is_set_key_v<T> && (
+            std::is_same_v<std::decay_t<Predicate>, std::less<T>> ||
+            std::is_same_v<std::decay_t<Predicate>, std::less<>>);
+}
+
+namespace sort::simd::detail
+{
+    template<typename T>
+    size_t intersect_scalar(const T* a, size_t a_size, const T* b, size_t b_size, T* out) {
+        size_t i = 0;
+        size_t j = 0;
+        size_t count = 0;
+        while (i < a_size && j < b_size) {
+            if (a[i] < b[j]) {
+                ++i;
+            }
+            else if (b[j] < a[i]) {
+                ++j;
+            }
+            else {
+                out[count++] = a[i];
+                ++i;
+                ++j;
+            }
+        }
+        return count;
+    }
+
+    // Per instruction set entry points
+
+    size_t intersect_sorted_sse42(const int32_t* a, size_t a_size, const int32_t* b, size_t b_size, int32_t* out);
+    size_t intersect_sorted_sse42(const uint32_t* a, size_t a_size, const uint32_t* b, size_t b_size, uint32_t* out);
+}
@@ -0,0 +1,75 @@
+#include "set_intersection.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+
+#include <nmmintrin.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace sort::simd::detail
+{
+    namespace
+    {
+        constexpr size_t lanes = 4;
+
+        size_t lowest_bit(unsigned mask) {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanForward(&index, mask);
+            return index;
+#else
+            return static_cast<size_t>(__builtin_ctz(mask));
+#endif
+        }
+
+        /// Compares blocks of 4 elements of each array all-to-all with 4 rotations of one block.
+        /// The block with the smaller last element is consumed, both when last elements are equal.
+        /// Lanes of 'a' that matched are written in order, so output stays sorted
+        template<typename T>
+        size_t intersect_blocks(const T* a, size_t a_size, const T* b, size_t b_size, T* out) {
+            size_t i = 0;
+            size_t j = 0;
+            size_t count = 0;
+            while (i + lanes <= a_size && j + lanes <= b_size) {
+                const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+                const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+
+                const __m128i eq0 = _mm_cmpeq_epi32(va, vb);
+                const __m128i eq1 = _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1)));
+                const __m128i eq2 = _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2)));
+                const __m128i eq3 = _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3)));
+                const __m128i any = _mm_or_si128(_mm_or_si128(eq0, eq1), _mm_or_si128(eq2, eq3));
+
+                // 'out' may alias 'a': matched lanes are read before the block is left
+                unsigned mask = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(any)));
+                while (mask != 0) {
+                    out[count++] = a[i + lowest_bit(mask)];
+                    mask &= mask - 1;
+                }
+
+                const T a_last = a[i + lanes - 1];
+                const T b_last = b[j + lanes - 1];
+                if (!(b_last < a_last)) {
+                    i += lanes;
+                }
+                if (!(a_last < b_last)) {
+                    j += lanes;
+                }
+            }
+
+            return count + intersect_scalar(a + i, a_size - i, b + j, b_size - j, out + count);
+        }
+    }
+
+    size_t intersect_sorted_sse42(const int32_t* a, size_t a_size, const int32_t* b, size_t b_size, int32_t* out) {
+        return intersect_blocks(a, a_size, b, b_size, out);
+    }
+
+    size_t intersect_sorted_sse42(const uint32_t* a, size_t a_size, const uint32_t* b, size_t b_size, uint32_t* out) {
+        return intersect_blocks(a, a_size, b, b_size, out);
+    }
+}
+
+#endif
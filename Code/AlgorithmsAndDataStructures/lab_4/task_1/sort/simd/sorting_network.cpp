@@ -0,0 +1,220 @@
+#include "sorting_network.h"
+#include "sorting_network_impl.h"
+
+#include <atomic>
+
+#if SORT_SIMD_X86 && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace sort::simd::detail
+{
+    static_assert(network_capacity == max_network_size);
+
+    namespace
+    {
+        template<typename T>
+        struct scalar_traits
+        {
+            using value_type = T;
+            using vec = T;
+            static constexpr size_t lanes = 1;
+
+            static vec load(const value_type* p) {
+                return *p;
+            }
+
+            static void store(value_type* p, vec v) {
+                *p = v;
+            }
+
+            static void minmax(vec a, vec b, vec& lo, vec& hi) {
+                const bool swap = b < a;
+                lo = swap ? b : a;
+                hi = swap ? a : b;
+            }
+
+            static vec reverse(vec v) {
+                return v;
+            }
+
+            static vec compare_exchange_xor(vec v, size_t, size_t) {
+                return v;
+            }
+
+            static value_type sentinel() {
+                using limits = std::numeric_limits<value_type>;
+                if constexpr (limits::has_infinity) {
+                    return limits::infinity();
+                }
+                else {
+                    return limits::max();
+                }
+            }
+        };
+    }
+
+    void sort_network_scalar(int32_t* array, size_t size) {
+        sort_block<scalar_traits<int32_t>>(array, size);
+    }
+
+    void sort_network_scalar(uint32_t* array, size_t size) {
+        sort_block<scalar_traits<uint32_t>>(array, size);
+    }
+
+    void sort_network_scalar(float* array, size_t size) {
+        sort_block<scalar_traits<float>>(array, size);
+    }
+
+    void merge_sorted_scalar(const int32_t* a, size_t a_size, const int32_t* b, size_t b_size, int32_t* out) {
+        merge_scalar(a, a_size, b, b_size, out);
+    }
+
+    void merge_sorted_scalar(const uint32_t* a, size_t a_size, const uint32_t* b, size_t b_size, uint32_t* out) {
+        merge_scalar(a, a_size, b, b_size, out);
+    }
+
+    void merge_sorted_scalar(const float* a, size_t a_size, const float* b, size_t b_size, float* out) {
+        merge_scalar(a, a_size, b, b_size, out);
+    }
+
+#if !SORT_SIMD_X86
+    // Vector kernels exist only for x86, other platforms are served by scalar ones
+    void sort_network_sse42(int32_t*, size_t) {}
+    void sort_network_sse42(uint32_t*, size_t) {}
+    void sort_network_sse42(float*, size_t) {}
+    void merge_sorted_sse42(const int32_t*, size_t, const int32_t*, size_t, int32_t*) {}
+    void merge_sorted_sse42(const uint32_t*, size_t, const uint32_t*, size_t, uint32_t*) {}
+    void merge_sorted_sse42(const float*, size_t, const float*, size_t, float*) {}
+    void sort_network_avx2(int32_t*, size_t) {}
+    void sort_network_avx2(uint32_t*, size_t) {}
+    void sort_network_avx2(float*, size_t) {}
+    void merge_sorted_avx2(const int32_t*, size_t, const int32_t*, size_t, int32_t*) {}
+    void merge_sorted_avx2(const uint32_t*, size_t, const uint32_t*, size_t, uint32_t*) {}
+    void merge_sorted_avx2(const float*, size_t, const float*, size_t, float*) {}
+#endif
+
+    namespace
+    {
+        isa detect_isa() {
+#if SORT_SIMD_X86
+#if defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 0);
+            const int max_leaf = info[0];
+
+            __cpuid(info, 1);
+            const bool sse42 = (info[2] & (1 << 20)) != 0;
+            const bool osxsave = (info[2] & (1 << 27)) != 0;
+            const bool avx = (info[2] & (1 << 28)) != 0;
+
+            bool avx2 = false;
+            if (max_leaf >= 7 && osxsave && avx) {
+                // OS must save YMM registers on context switch
+                const bool ymm_enabled = (_xgetbv(0) & 0x6) == 0x6;
+                __cpuidex(info, 7, 0);
+                avx2 = ymm_enabled && (info[1] & (1 << 5)) != 0;
+            }
+#else
+            __builtin_cpu_init();
+            const bool avx2 = __builtin_cpu_supports("avx2");
+            const bool sse42 = __builtin_cpu_supports("sse4.2");
+#endif
+            if (avx2) {
+                return isa::avx2;
+            }
+
+            if (sse42) {
+                return isa::sse42;
+            }
+#endif
+            return isa::scalar;
+        }
+
+        std::atomic<isa> isa_limit = isa::avx2;
+
+        template<typename T>
+        void sort_network_dispatch(T* array, size_t size) {
+            switch (active_isa()) {
+            case isa::avx2:
+                sort_network_avx2(array, size);
+                break;
+            case isa::sse42:
+                sort_network_sse42(array, size);
+                break;
+            default:
+                sort_network_scalar(array, size);
+                break;
+            }
+        }
+
+        template<typename T>
+        void merge_sorted_dispatch(const T* a, size_t a_size, const T* b, size_t b_size, T* out) {
+            switch (active_isa()) {
+            case isa::avx2:
+                merge_sorted_avx2(a, a_size, b, b_size, out);
+                break;
+            case isa::sse42:
+                merge_sorted_sse42(a, a_size, b, b_size, out);
+                break;
+            default:
+                merge_sorted_scalar(a, a_size, b, b_size, out);
+                break;
+            }
+        }
+    }
+}
+
+namespace sort::simd
+{
+    isa best_isa() {
+        static const isa detected = detail::detect_isa();
+        return detected;
+    }
+
+    isa active_isa() {
+        const isa best = best_isa();
+        const isa limit = detail::isa_limit.load(std::memory_order_relaxed);
+        return static_cast<int>(limit) < static_cast<int>(best) ? limit : best;
+    }
+
+    void limit_isa(isa max) {
+        detail::isa_limit.store(max, std::memory_order_relaxed);
+    }
+
+    const char* isa_name(isa value) {
+        switch (value) {
+        case isa::avx2:
+            return "AVX2";
+        case isa::sse42:
+            return "SSE4.2";
+        default:
+            return "scalar";
+        }
+    }
+
+    void sort_network(int32_t* array, size_t size) {
+        detail::sort_network_dispatch(array, size);
+    }
+
+    void sort_network(uint32_t* array, size_t size) {
+        detail::sort_network_dispatch(array, size);
+    }
+
+    void sort_network(float* array, size_t size) {
+        detail::sort_network_dispatch(array, size);
+    }
+
+    void merge_sorted(const int32_t* a, size_t a_size, const int32_t* b, size_t b_size, int32_t* out) {
+        detail::merge_sorted_dispatch(a, a_size, b, b_size, out);
+    }
+
+    void merge_sorted(const uint32_t* a, size_t a_size, const uint32_t* b, size_t b_size, uint32_t* out) {
+        detail::merge_sorted_dispatch(a, a_size, b, b_size, out);
+    }
+
+    void merge_sorted(const float* a, size_t a_size, const float* b, size_t b_size, float* out) {
+        detail::merge_sorted_dispatch(a, a_size, b, b_size, out);
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SORT_SIMD_X86 1
+#else
+#define SORT_SIMD_X86 0
+#endif
+
+namespace sort::simd
+{
+    /// Instruction sets that have their own sorting network kernels
+    enum class isa
+    {
+        scalar,
+        sse42,
+        avx2
+    };
+
+    /// Networks sort blocks up to this size (and at least 8 elements wide internally)
+    constexpr size_t max_network_size = 256;
+
+    /// The widest instruction set supported by this CPU (detected once)
+    isa best_isa();
+
+    /// Instruction set used by kernels: best_isa() unless limited by limit_isa()
+    isa active_isa();
+
+    /// Forbids kernels wider than 'max' (to compare instruction sets in benchmarks)
+    void limit_isa(isa max);
+
+    const char* isa_name(isa value);
+
+    /// Sorts up to max_network_size keys in ascending order with bitonic sorting network.
+    /// Float keys must not be NaN.
+    void sort_network(int32_t* array, size_t size);
+    void sort_network(uint32_t* array, size_t size);
+    void sort_network(float* array, size_t size);
+
+    /// Merges two sorted in ascending order runs into 'out'
+    /// 'out' must not overlap with inputs
+    void merge_sorted(const int32_t* a, size_t a_size, const int32_t* b, size_t b_size, int32_t* out);
+    void merge_sorted(const uint32_t* a, size_t a_size, const uint32_t* b, size_t b_size, uint32_t* out);
+    void merge_sorted(const float* a, size_t a_size, const float* b, size_t b_size, float* out);
+
+    template<typename T>
+    constexpr bool is_network_key_v =
+        std::is_same_v<T, int32_t> ||
+        std::is_same_v<T, uint32_t> ||
+        std::is_same_v<T, float>;
+
+    /// True if sort::*_sort<T, Predicate> may use network kernels as base case
+    template<typename T, typename Predicate>
+    constexpr bool is_network_sortable_v =
+        is_network_key_v<T> && (
+            std::is_same_v<std::decay_t<Predicate>, std::less<T>> ||
+            std::is_same_v<std::decay_t<Predicate>, std::less<>>);
+
+    /// Limits kernels instruction set while in scope
+    class scoped_isa_limit
+    {
+    public:
+        scoped_isa_limit(isa max) :
+            m_previous(active_isa())
+        {
+            limit_isa(max);
+        }
+
+        ~scoped_isa_limit() {
+            limit_isa(m_previous);
+        }
+
+    private:
+        isa m_previous;
+    };
+}
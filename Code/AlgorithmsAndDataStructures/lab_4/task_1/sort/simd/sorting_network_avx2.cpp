@@ -0,0 +1,207 @@
+#include "sorting_network_impl.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+
+#include <immintrin.h>
+
+namespace sort::simd::detail
+{
+    namespace
+    {
+        // Lanes permutations for 'lane ^ mask' inside 128 bit halves
+        constexpr int xor_1 = _MM_SHUFFLE(2, 3, 0, 1);
+        constexpr int xor_2 = _MM_SHUFFLE(1, 0, 3, 2);
+        constexpr int xor_3 = _MM_SHUFFLE(0, 1, 2, 3);
+
+        // Blend masks of lanes which have 'upper_bit' set in index
+        constexpr int upper_1 = 0xAA;
+        constexpr int upper_2 = 0xCC;
+        constexpr int upper_4 = 0xF0;
+
+        inline __m256i reverse_index() {
+            return _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+        }
+
+        inline __m256i upper_lanes(size_t upper_bit) {
+            const __m256i bit = _mm256_set1_epi32(static_cast<int>(upper_bit));
+            const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+            return _mm256_cmpeq_epi32(_mm256_and_si256(lane, bit), bit);
+        }
+
+        template<typename T, typename Ops>
+        struct avx2_integer_traits
+        {
+            using value_type = T;
+            using vec = __m256i;
+            static constexpr size_t lanes = 8;
+
+            static vec load(const value_type* p) {
+                return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            }
+
+            static void store(value_type* p, vec v) {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+            }
+
+            static void minmax(vec a, vec b, vec& lo, vec& hi) {
+                lo = Ops::min(a, b);
+                hi = Ops::max(a, b);
+            }
+
+            static vec reverse(vec v) {
+                return _mm256_permutevar8x32_epi32(v, reverse_index());
+            }
+
+            static vec permute_xor(vec v, size_t mask) {
+                switch (mask) {
+                case 1:
+                    return _mm256_shuffle_epi32(v, xor_1);
+                case 2:
+                    return _mm256_shuffle_epi32(v, xor_2);
+                case 3:
+                    return _mm256_shuffle_epi32(v, xor_3);
+                case 4:
+                    return _mm256_permute2x128_si256(v, v, 1);
+                case 7:
+                    return reverse(v);
+                default:
+                {
+                    const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+                    const __m256i index = _mm256_xor_si256(lane, _mm256_set1_epi32(static_cast<int>(mask)));
+                    return _mm256_permutevar8x32_epi32(v, index);
+                }
+                }
+            }
+
+            static vec compare_exchange_xor(vec v, size_t mask, size_t upper_bit) {
+                const vec p = permute_xor(v, mask);
+                const vec lo = Ops::min(v, p);
+                const vec hi = Ops::max(v, p);
+                switch (upper_bit) {
+                case 1:
+                    return _mm256_blend_epi32(lo, hi, upper_1);
+                case 2:
+                    return _mm256_blend_epi32(lo, hi, upper_2);
+                default:
+                    return _mm256_blend_epi32(lo, hi, upper_4);
+                }
+            }
+
+            static value_type sentinel() {
+                return std::numeric_limits<value_type>::max();
+            }
+        };
+
+        struct int32_ops
+        {
+            static __m256i min(__m256i a, __m256i b) {
+                return _mm256_min_epi32(a, b);
+            }
+
+            static __m256i max(__m256i a, __m256i b) {
+                return _mm256_max_epi32(a, b);
+            }
+        };
+
+        struct uint32_ops
+        {
+            static __m256i min(__m256i a, __m256i b) {
+                return _mm256_min_epu32(a, b);
+            }
+
+            static __m256i max(__m256i a, __m256i b) {
+                return _mm256_max_epu32(a, b);
+            }
+        };
+
+        struct avx2_float_traits
+        {
+            using value_type = float;
+            using vec = __m256;
+            static constexpr size_t lanes = 8;
+
+            static vec load(const value_type* p) {
+                return _mm256_loadu_ps(p);
+            }
+
+            static void store(value_type* p, vec v) {
+                _mm256_storeu_ps(p, v);
+            }
+
+            // min/max instructions do not keep sign of zero, so select by comparison
+            static void minmax(vec a, vec b, vec& lo, vec& hi) {
+                const vec swap = _mm256_cmp_ps(b, a, _CMP_LT_OQ);
+                lo = _mm256_blendv_ps(a, b, swap);
+                hi = _mm256_blendv_ps(b, a, swap);
+            }
+
+            static vec reverse(vec v) {
+                return _mm256_permutevar8x32_ps(v, reverse_index());
+            }
+
+            static vec permute_xor(vec v, size_t mask) {
+                switch (mask) {
+                case 1:
+                    return _mm256_shuffle_ps(v, v, xor_1);
+                case 2:
+                    return _mm256_shuffle_ps(v, v, xor_2);
+                case 3:
+                    return _mm256_shuffle_ps(v, v, xor_3);
+                case 4:
+                    return _mm256_permute2f128_ps(v, v, 1);
+                case 7:
+                    return reverse(v);
+                default:
+                {
+                    const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+                    const __m256i index = _mm256_xor_si256(lane, _mm256_set1_epi32(static_cast<int>(mask)));
+                    return _mm256_permutevar8x32_ps(v, index);
+                }
+                }
+            }
+
+            static vec compare_exchange_xor(vec v, size_t mask, size_t upper_bit) {
+                const vec p = permute_xor(v, mask);
+                const vec upper = _mm256_castsi256_ps(upper_lanes(upper_bit));
+                const vec swap = _mm256_blendv_ps(
+                    _mm256_cmp_ps(p, v, _CMP_LT_OQ),
+                    _mm256_cmp_ps(v, p, _CMP_LT_OQ),
+                    upper);
+                return _mm256_blendv_ps(v, p, swap);
+            }
+
+            static value_type sentinel() {
+                return std::numeric_limits<value_type>::infinity();
+            }
+        };
+
+        using avx2_int32_traits = avx2_integer_traits<int32_t, int32_ops>;
+        using avx2_uint32_traits = avx2_integer_traits<uint32_t, uint32_ops>;
+    }
+
+    void sort_network_avx2(int32_t* array, size_t size) {
+        sort_block<avx2_int32_traits>(array, size);
+    }
+
+    void sort_network_avx2(uint32_t* array, size_t size) {
+        sort_block<avx2_uint32_traits>(array, size);
+    }
+
+    void sort_network_avx2(float* array, size_t size) {
+        sort_block<avx2_float_traits>(array, size);
+    }
+
+    void merge_sorted_avx2(const int32_t* a, size_t a_size, const int32_t* b, size_t b_size, int32_t* out) {
+        merge_sorted<avx2_int32_traits>(a, a_size, b, b_size, out);
+    }
+
+    void merge_sorted_avx2(const uint32_t* a, size_t a_size, const uint32_t* b, size_t b_size, uint32_t* out) {
+        merge_sorted<avx2_uint32_traits>(a, a_size, b, b_size, out);
+    }
+
+    void merge_sorted_avx2(const float* a, size_t a_size, const float* b, size_t b_size, float* out) {
+        merge_sorted<avx2_float_traits>(a, a_size, b, b_size, out);
+    }
+}
+
+#endif
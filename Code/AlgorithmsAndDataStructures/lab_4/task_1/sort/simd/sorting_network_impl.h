@@ -0,0 +1,257 @@
+#pragma once
+
+// Generic bitonic network used by every instruction set specific translation unit.
+// Keep includes minimal: this header is compiled with different target flags.
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace sort::simd::detail
+{
+// Internal linkage: every instruction set gets its own copy of these templates
+namespace
+{
+    /// Traits interface:
+    ///     value_type, vec, lanes
+    ///     vec load(const value_type*), void store(value_type*, vec)
+    ///     void minmax(vec a, vec b, vec& lo, vec& hi)
+    ///     vec reverse(vec)
+    ///     vec compare_exchange_xor(vec, size_t mask, size_t upper_bit)
+    ///         - compare lane l with lane l ^ mask, lanes with 'upper_bit' set take max
+
+    constexpr size_t network_capacity = 256;
+
+    constexpr size_t next_power_of_two(size_t value) {
+        size_t result = 1;
+        while (result < value) {
+            result *= 2;
+        }
+        return result;
+    }
+
+    /// Sorts 'vectors_count' * lanes values (vectors_count is power of two)
+    /// Uses network where all comparators have the same direction:
+    /// for each stage 'k' the first step compares i and i ^ (k - 1) ("flip")
+    /// and the others compare i and i ^ j for j = k / 4 ... 1 ("half cleaners")
+    template<typename Traits>
+    void bitonic_sort_vectors(typename Traits::vec* v, size_t vectors_count) {
+        using vec = typename Traits::vec;
+        constexpr size_t lanes = Traits::lanes;
+        const size_t total = vectors_count * lanes;
+
+        for (size_t k = 2; k <= total; k *= 2) {
+            if (k <= lanes) {
+                for (size_t i = 0; i < vectors_count; ++i) {
+                    v[i] = Traits::compare_exchange_xor(v[i], k - 1, k / 2);
+                }
+            }
+            else {
+                const size_t block = k / lanes;
+                for (size_t base = 0; base < vectors_count; base += block) {
+                    for (size_t t = 0; t < block / 2; ++t) {
+                        vec& a = v[base + t];
+                        vec& b = v[base + block - 1 - t];
+                        vec lo;
+                        vec hi;
+                        Traits::minmax(a, Traits::reverse(b), lo, hi);
+                        a = lo;
+                        b = Traits::reverse(hi);
+                    }
+                }
+            }
+
+            for (size_t j = k / 4; j >= 1; j /= 2) {
+                if (j < lanes) {
+                    for (size_t i = 0; i < vectors_count; ++i) {
+                        v[i] = Traits::compare_exchange_xor(v[i], j, j);
+                    }
+                }
+                else {
+                    const size_t distance = j / lanes;
+                    for (size_t i = 0; i < vectors_count; ++i) {
+                        if ((i & distance) == 0) {
+                            Traits::minmax(v[i], v[i + distance], v[i], v[i + distance]);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    template<typename Traits>
+    void sort_block(typename Traits::value_type* array, size_t size) {
+        using value_type = typename Traits::value_type;
+        using vec = typename Traits::vec;
+        constexpr size_t lanes = Traits::lanes;
+        constexpr size_t min_size = lanes < 8 ? 8 : lanes;
+
+        assert(size <= network_capacity);
+        if (size < 2) {
+            return;
+        }
+
+        size_t padded_size = next_power_of_two(size);
+        padded_size = padded_size < min_size ? min_size : padded_size;
+
+        // Padding values go to the end and are dropped
+        value_type buffer[network_capacity];
+        for (size_t i = 0; i < size; ++i) {
+            buffer[i] = array[i];
+        }
+        for (size_t i = size; i < padded_size; ++i) {
+            buffer[i] = Traits::sentinel();
+        }
+
+        const size_t vectors_count = padded_size / lanes;
+        vec v[network_capacity / lanes];
+        for (size_t i = 0; i < vectors_count; ++i) {
+            v[i] = Traits::load(buffer + i * lanes);
+        }
+
+        bitonic_sort_vectors<Traits>(v, vectors_count);
+
+        for (size_t i = 0; i < vectors_count; ++i) {
+            Traits::store(buffer + i * lanes, v[i]);
+        }
+        for (size_t i = 0; i < size; ++i) {
+            array[i] = buffer[i];
+        }
+    }
+
+    template<typename T>
+    void merge_scalar(const T* a, size_t a_size, const T* b, size_t b_size, T* out) {
+        size_t i = 0;
+        size_t j = 0;
+        while (i < a_size && j < b_size) {
+            if (b[j] < a[i]) {
+                *out++ = b[j++];
+            }
+            else {
+                *out++ = a[i++];
+            }
+        }
+        while (i < a_size) {
+            *out++ = a[i++];
+        }
+        while (j < b_size) {
+            *out++ = b[j++];
+        }
+    }
+
+    /// Merges two sorted vectors: 'a' receives the lowest lanes values, 'b' the highest
+    template<typename Traits>
+    void bitonic_merge_vectors(typename Traits::vec& a, typename Traits::vec& b) {
+        Traits::minmax(a, Traits::reverse(b), a, b);
+        for (size_t j = Traits::lanes / 2; j >= 1; j /= 2) {
+            a = Traits::compare_exchange_xor(a, j, j);
+            b = Traits::compare_exchange_xor(b, j, j);
+        }
+    }
+
+    template<typename Traits>
+    void merge_sorted(
+        const typename Traits::value_type* a, size_t a_size,
+        const typename Traits::value_type* b, size_t b_size,
+        typename Traits::value_type* out)
+    {
+        using value_type = typename Traits::value_type;
+        using vec = typename Traits::vec;
+        constexpr size_t lanes = Traits::lanes;
+
+        if (lanes == 1 || a_size < lanes || b_size < lanes) {
+            merge_scalar(a, a_size, b, b_size, out);
+            return;
+        }
+
+        vec low = Traits::load(a);
+        vec high = Traits::load(b);
+        size_t i = lanes;
+        size_t j = lanes;
+        while (true) {
+            bitonic_merge_vectors<Traits>(low, high);
+            Traits::store(out, low);
+            out += lanes;
+
+            // Next vector comes from the run with the smallest head
+            bool take_a;
+            if (i < a_size && j < b_size) {
+                take_a = !(b[j] < a[i]);
+            }
+            else {
+                take_a = i < a_size;
+            }
+
+            if (take_a) {
+                if (i + lanes > a_size) {
+                    break;
+                }
+                low = Traits::load(a + i);
+                i += lanes;
+            }
+            else {
+                if (j + lanes > b_size) {
+                    break;
+                }
+                low = Traits::load(b + j);
+                j += lanes;
+            }
+        }
+
+        // 'high' and the rest of both runs are still not merged
+        value_type tail[lanes];
+        Traits::store(tail, high);
+        size_t t = 0;
+        while (t < lanes) {
+            // 0 - tail, 1 - first run, 2 - second run
+            int source = 0;
+            value_type value = tail[t];
+            if (i < a_size && a[i] < value) {
+                source = 1;
+                value = a[i];
+            }
+            if (j < b_size && b[j] < value) {
+                source = 2;
+                value = b[j];
+            }
+
+            *out++ = value;
+            if (source == 0) {
+                ++t;
+            }
+            else if (source == 1) {
+                ++i;
+            }
+            else {
+                ++j;
+            }
+        }
+        merge_scalar(a + i, a_size - i, b + j, b_size - j, out);
+    }
+
+}
+
+    // Per instruction set entry points
+
+    void sort_network_scalar(int32_t* array, size_t size);
+    void sort_network_scalar(uint32_t* array, size_t size);
+    void sort_network_scalar(float* array, size_t size);
+    void merge_sorted_scalar(const int32_t* a, size_t a_size, const int32_t* b, size_t b_size, int32_t* out);
+    void merge_sorted_scalar(const uint32_t* a, size_t a_size, const uint32_t* b, size_t b_size, uint32_t* out);
+    void merge_sorted_scalar(const float* a, size_t a_size, const float* b, size_t b_size, float* out);
+
+    void sort_network_sse42(int32_t* array, size_t size);
+    void sort_network_sse42(uint32_t* array, size_t size);
+    void sort_network_sse42(float* array, size_t size);
+    void merge_sorted_sse42(const int32_t* a, size_t a_size, const int32_t* b, size_t b_size, int32_t* out);
+    void merge_sorted_sse42(const uint32_t* a, size_t a_size, const uint32_t* b, size_t b_size, uint32_t* out);
+    void merge_sorted_sse42(const float* a, size_t a_size, const float* b, size_t b_size, float* out);
+
+    void sort_network_avx2(int32_t* array, size_t size);
+    void sort_network_avx2(uint32_t* array, size_t size);
+    void sort_network_avx2(float* array, size_t size);
+    void merge_sorted_avx2(const int32_t* a, size_t a_size, const int32_t* b, size_t b_size, int32_t* out);
+    void merge_sorted_avx2(const uint32_t* a, size_t a_size, const uint32_t* b, size_t b_size, uint32_t* out);
+    void merge_sorted_avx2(const float* a, size_t a_size, const float* b, size_t b_size, float* out);
+}
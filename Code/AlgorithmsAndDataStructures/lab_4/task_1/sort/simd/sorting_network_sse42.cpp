@@ -0,0 +1,168 @@
+#include "sorting_network_impl.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+
+#include <nmmintrin.h>
+
+namespace sort::simd::detail
+{
+    namespace
+    {
+        // Lanes permutations for 'lane ^ mask'
+        constexpr int xor_1 = _MM_SHUFFLE(2, 3, 0, 1);
+        constexpr int xor_2 = _MM_SHUFFLE(1, 0, 3, 2);
+        constexpr int xor_3 = _MM_SHUFFLE(0, 1, 2, 3);
+
+        template<typename T, typename Ops>
+        struct sse42_integer_traits
+        {
+            using value_type = T;
+            using vec = __m128i;
+            static constexpr size_t lanes = 4;
+
+            static vec load(const value_type* p) {
+                return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            }
+
+            static void store(value_type* p, vec v) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);
+            }
+
+            static void minmax(vec a, vec b, vec& lo, vec& hi) {
+                lo = Ops::min(a, b);
+                hi = Ops::max(a, b);
+            }
+
+            static vec reverse(vec v) {
+                return _mm_shuffle_epi32(v, xor_3);
+            }
+
+            static vec compare_exchange_xor(vec v, size_t mask, size_t upper_bit) {
+                vec p;
+                switch (mask) {
+                case 1:
+                    p = _mm_shuffle_epi32(v, xor_1);
+                    break;
+                case 2:
+                    p = _mm_shuffle_epi32(v, xor_2);
+                    break;
+                default:
+                    p = _mm_shuffle_epi32(v, xor_3);
+                    break;
+                }
+
+                const vec lo = Ops::min(v, p);
+                const vec hi = Ops::max(v, p);
+                // Blend by 16 bit words: two words per lane
+                return upper_bit == 1 ? _mm_blend_epi16(lo, hi, 0xCC) : _mm_blend_epi16(lo, hi, 0xF0);
+            }
+
+            static value_type sentinel() {
+                return std::numeric_limits<value_type>::max();
+            }
+        };
+
+        struct int32_ops
+        {
+            static __m128i min(__m128i a, __m128i b) {
+                return _mm_min_epi32(a, b);
+            }
+
+            static __m128i max(__m128i a, __m128i b) {
+                return _mm_max_epi32(a, b);
+            }
+        };
+
+        struct uint32_ops
+        {
+            static __m128i min(__m128i a, __m128i b) {
+                return _mm_min_epu32(a, b);
+            }
+
+            static __m128i max(__m128i a, __m128i b) {
+                return _mm_max_epu32(a, b);
+            }
+        };
+
+        struct sse42_float_traits
+        {
+            using value_type = float;
+            using vec = __m128;
+            static constexpr size_t lanes = 4;
+
+            static vec load(const value_type* p) {
+                return _mm_loadu_ps(p);
+            }
+
+            static void store(value_type* p, vec v) {
+                _mm_storeu_ps(p, v);
+            }
+
+            // min/max instructions do not keep sign of zero, so select by comparison
+            static void minmax(vec a, vec b, vec& lo, vec& hi) {
+                const vec swap = _mm_cmplt_ps(b, a);
+                lo = _mm_blendv_ps(a, b, swap);
+                hi = _mm_blendv_ps(b, a, swap);
+            }
+
+            static vec reverse(vec v) {
+                return _mm_shuffle_ps(v, v, xor_3);
+            }
+
+            static vec compare_exchange_xor(vec v, size_t mask, size_t upper_bit) {
+                vec p;
+                switch (mask) {
+                case 1:
+                    p = _mm_shuffle_ps(v, v, xor_1);
+                    break;
+                case 2:
+                    p = _mm_shuffle_ps(v, v, xor_2);
+                    break;
+                default:
+                    p = _mm_shuffle_ps(v, v, xor_3);
+                    break;
+                }
+
+                // Lanes which take the max value from the pair
+                const vec upper = upper_bit == 1 ?
+                    _mm_castsi128_ps(_mm_setr_epi32(0, -1, 0, -1)) :
+                    _mm_castsi128_ps(_mm_setr_epi32(0, 0, -1, -1));
+                const vec swap = _mm_blendv_ps(_mm_cmplt_ps(p, v), _mm_cmplt_ps(v, p), upper);
+                return _mm_blendv_ps(v, p, swap);
+            }
+
+            static value_type sentinel() {
+                return std::numeric_limits<value_type>::infinity();
+            }
+        };
+
+        using sse42_int32_traits = sse42_integer_traits<int32_t, int32_ops>;
+        using sse42_uint32_traits = sse42_integer_traits<uint32_t, uint32_ops>;
+    }
+
+    void sort_network_sse42(int32_t* array, size_t size) {
+        sort_block<sse42_int32_traits>(array, size);
+    }
+
+    void sort_network_sse42(uint32_t* array, size_t size) {
+        sort_block<sse42_uint32_traits>(array, size);
+    }
+
+    void sort_network_sse42(float* array, size_t size) {
+        sort_block<sse42_float_traits>(array, size);
+    }
+
+    void merge_sorted_sse42(const int32_t* a, size_t a_size, const int32_t* b, size_t b_size, int32_t* out) {
+        merge_sorted<sse42_int32_traits>(a, a_size, b, b_size, out);
+    }
+
+    void merge_sorted_sse42(const uint32_t* a, size_t a_size, const uint32_t* b, size_t b_size, uint32_t* out) {
+        merge_sorted<sse42_uint32_traits>(a, a_size, b, b_size, out);
+    }
+
+    void merge_sorted_sse42(const float* a, size_t a_size, const float* b, size_t b_size, float* out) {
+        merge_sorted<sse42_float_traits>(a, a_size, b, b_size, out);
+    }
+}
+
+#endif
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "quick_sort.h"
+#include "radix_sort.h"
+#include "scratch_arena.h"
+
+namespace sort::sort_by_key_impl
+{
+    constexpr size_t radix_bits = 8;
+    constexpr size_t radix = size_t{ 1 } << radix_bits;
+
+    // Values up to this size are moved together with keys by radix passes,
+    // wider ones are permuted once at the end
+    constexpr size_t max_carried_value_size = 8;
+
+    template<typename Key, typename Predicate>
+    constexpr bool is_radix_key_v =
+        std::is_integral_v<Key> && !std::is_same_v<Key, bool> &&
+        (std::is_same_v<std::decay_t<Predicate>, std::less<Key>> || std::is_same_v<std::decay_t<Predicate>, std::greater<Key>>);
+
+    template<typename Key, typename Predicate>
+    constexpr bool is_ascending_v = !std::is_same_v<std::decay_t<Predicate>, std::greater<Key>>;
+
+    template<bool ascending, typename Key>
+    std::make_unsigned_t<Key> radix_key(Key key) {
+        const auto u = radix_sort_impl::to_unsigned_key(key);
+        if constexpr (ascending) {
+            return u;
+        }
+        else {
+            return static_cast<std::make_unsigned_t<Key>>(~u);
+        }
+    }
+
+    /// Stable LSD radix sort of keys carrying values.
+    /// Histograms of all bytes are built in one pass; bytes equal for all keys are skipped.
+    /// Result is in 'keys' and 'values', buffers must have space for 'size' elements
+    template<bool ascending, typename Key, typename Value>
+    void radix_sort_pairs(Key* keys, Value* values, size_t size, Key* keys_buffer, Value* values_buffer) {
+        constexpr size_t bytes_count = sizeof(Key);
+
+        size_t counts[bytes_count][radix] = {};
+        for (size_t i = 0; i < size; ++i) {
+            const auto key = radix_key<ascending>(keys[i]);
+            for (size_t b = 0; b < bytes_count; ++b) {
+                ++counts[b][(key >> (b * radix_bits)) & (radix - 1)];
+            }
+        }
+
+        Key* source_keys = keys;
+        Value* source_values = values;
+        Key* destination_keys = keys_buffer;
+        Value* destination_values = values_buffer;
+        for (size_t b = 0; b < bytes_count; ++b) {
+            size_t* offsets = counts[b];
+            const auto key_sample = radix_key<ascending>(source_keys[0]);
+            if (offsets[(key_sample >> (b * radix_bits)) & (radix - 1)] == size) {
+                continue;
+            }
+
+            size_t sum = 0;
+            for (size_t d = 0; d < radix; ++d) {
+                const size_t count = offsets[d];
+                offsets[d] = sum;
+                sum += count;
+            }
+
+            for (size_t i = 0; i < size; ++i) {
+                const auto key = radix_key<ascending>(source_keys[i]);
+                const size_t position = offsets[(key >> (b * radix_bits)) & (radix - 1)]++;
+                destination_keys[position] = source_keys[i];
+                destination_values[position] = source_values[i];
+            }
+
+            std::swap(source_keys, destination_keys);
+            std::swap(source_values, destination_values);
+        }
+
+        if (source_keys != keys) {
+            std::copy_n(source_keys, size, keys);
+            std::copy_n(source_values, size, values);
+        }
+    }
+
+    // argsort without arena.reset(): allocations made before the call stay valid
+    template<typename Key, typename Index, typename Predicate>
+    void argsort_unreset(const Key* keys, size_t size, Index* permutation, scratch_arena& arena, Predicate& predicate) {
+        static_assert(std::is_integral_v<Index> && std::is_unsigned_v<Index>);
+        assert(size == 0 || size - 1 <= std::numeric_limits<Index>::max());
+
+        std::iota(permutation, permutation + size, Index{ 0 });
+        if (size < 2) {
+            return;
+        }
+
+        if constexpr (is_radix_key_v<Key, Predicate>) {
+            Key* sorted_keys = arena.allocate<Key>(size);
+            Key* keys_buffer = arena.allocate<Key>(size);
+            Index* indices_buffer = arena.allocate<Index>(size);
+            std::copy_n(keys, size, sorted_keys);
+            radix_sort_pairs<is_ascending_v<Key, Predicate>>(sorted_keys, permutation, size, keys_buffer, indices_buffer);
+        }
+        else if constexpr (std::is_trivially_copyable_v<Key>) {
+            struct keyed
+            {
+                Key key;
+                Index index;
+            };
+
+            keyed* pairs = arena.allocate<keyed>(size);
+            for (size_t i = 0; i < size; ++i) {
+                pairs[i].key = keys[i];
+                pairs[i].index = static_cast<Index>(i);
+            }
+
+            // Index breaks ties, so unstable sort gives stable order
+            sort::intro_sort(pairs, size, [&predicate](const keyed& a, const keyed& b) {
+                if (predicate(a.key, b.key)) {
+                    return true;
+                }
+                return !predicate(b.key, a.key) && a.index < b.index;
+            });
+
+            for (size_t i = 0; i < size; ++i) {
+                permutation[i] = pairs[i].index;
+            }
+        }
+        else {
+            sort::intro_sort(permutation, size, [keys, &predicate](Index a, Index b) {
+                if (predicate(keys[a], keys[b])) {
+                    return true;
+                }
+                return !predicate(keys[b], keys[a]) && a < b;
+            });
+        }
+    }
+}
+
+namespace sort
+{
+    /// Reorders arrays so element i becomes the element permutation[i] had before.
+    /// Follows cycles in place: every element is moved once, no copies of arrays are made.
+    /// 'permutation' is consumed (left as identity)
+    template<typename Index, typename... Arrays>
+    void apply_permutation(Index* permutation, size_t size, Arrays*... arrays) {
+        for (size_t i = 0; i < size; ++i) {
+            if (static_cast<size_t>(permutation[i]) == i) {
+                continue;
+            }
+
+            auto saved = std::make_tuple(std::move(arrays[i])...);
+            size_t j = i;
+            while (static_cast<size_t>(permutation[j]) != i) {
+                const size_t next = static_cast<size_t>(permutation[j]);
+                ((arrays[j] = std::move(arrays[next])), ...);
+                permutation[j] = static_cast<Index>(j);
+                j = next;
+            }
+            std::apply([&](auto&... values) {
+                ((arrays[j] = std::move(values)), ...);
+            }, saved);
+            permutation[j] = static_cast<Index>(j);
+        }
+    }
+
+    /// Stable LSD radix sort of integer keys carrying values of trivial type.
+    /// Values are moved with keys on every pass, so it suits narrow payloads (indices, ids).
+    /// Uses 'arena' for buffers and resets it before return
+    template
+    <
+        typename Key,
+        typename Value,
+        bool ascending = true,
+        typename enable = std::enable_if_t<std::is_integral_v<Key>>
+    >
+    void radix_sort_by_key(Key* keys, Value* values, size_t size, scratch_arena& arena) {
+        static_assert(std::is_trivially_copyable_v<Value>);
+        if (size < 2) {
+            return;
+        }
+
+        Key* keys_buffer = arena.allocate<Key>(size);
+        Value* values_buffer = arena.allocate<Value>(size);
+        sort_by_key_impl::radix_sort_pairs<ascending>(keys, values, size, keys_buffer, values_buffer);
+        arena.reset();
+    }
+
+    /// Fills 'permutation' so keys[permutation[0]], keys[permutation[1]], ... are sorted.
+    /// Stable: equal keys keep order of their indices.
+    /// Integer keys ordered by std::less or std::greater are sorted by radix sort carrying indices,
+    /// other trivially copyable keys are sorted as (key, index) pairs,
+    /// the rest are sorted indirectly through indices.
+    /// 'Index' must be able to hold size - 1. Uses 'arena' and resets it before return
+    template<typename Key, typename Index = uint32_t, typename Predicate = std::less<Key>>
+    void argsort(const Key* keys, size_t size, Index* permutation, scratch_arena& arena, Predicate predicate = Predicate()) {
+        sort_by_key_impl::argsort_unreset(keys, size, permutation, arena, predicate);
+        arena.reset();
+    }
+
+    /// Sorts keys and applies the same permutation to values. Stable.
+    /// Narrow trivial values under integer keys travel with keys through radix passes;
+    /// otherwise keys are argsorted and both arrays are permuted in place once,
+    /// so wide records are not moved until the order is known.
+    /// Uses 'arena' and resets it before return
+    template<typename Key, typename Value, typename Predicate = std::less<Key>>
+    void sort_by_key(Key* keys, Value* values, size_t size, scratch_arena& arena, Predicate predicate = Predicate()) {
+        using namespace sort_by_key_impl;
+        if (size < 2) {
+            return;
+        }
+
+        if constexpr (is_radix_key_v<Key, Predicate> && std::is_trivially_copyable_v<Value> && sizeof(Value) <= max_carried_value_size) {
+            radix_sort_by_key<Key, Value, is_ascending_v<Key, Predicate>>(keys, values, size, arena);
+        }
+        else {
+            auto permute = [&](auto* permutation) {
+                argsort_unreset(keys, size, permutation, arena, predicate);
+                apply_permutation(permutation, size, keys, values);
+                arena.reset();
+            };
+
+            if (size - 1 <= std::numeric_limits<uint32_t>::max()) {
+                permute(arena.allocate<uint32_t>(size));
+            }
+            else {
+                permute(arena.allocate<uint64_t>(size));
+            }
+        }
+    }
+}
@@ -0,0 +1,506 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include "sort/auto_sort.h"
+#include "sort/bubble_sort.h"
+#include "sort/counting_sort.h"
+#include "sort/quick_sort.h"
+#include "sort/merge_sort.h"
+#include "sort/heap_sort.h"
+#include "sort/integer_sort.h"
+#include "sort/radix_sort.h"
+#include "sort/sort_by_key.h"
+
+template<typename T>
+T* get_vector_data(std::vector<T>& vec) {
+    return vec.empty() ? nullptr : &vec[0];
+}
+
+template<typename T, typename Predicate>
+constexpr bool is_ascending_v = std::is_same_v<Predicate, std::less<T>>;
+
+template<typename T, typename Predicate>
+constexpr bool is_descending_v = std::is_same_v<Predicate, std::greater<T>>;
+
+// Parameters shared by all kernels of one benchmark run
+struct kernel_settings
+{
+    // The largest collection that will be sorted during the run
+    size_t max_size = 0;
+    sort::auto_sort_thresholds auto_sort_thresholds;
+};
+
+// Every sort kernel is a plain class template over element type and predicate:
+//   static constexpr std::string_view id()   - name used on the command line
+//   static constexpr std::string_view name() - column name in output tables
+//   static constexpr bool supported          - false if kernel can't sort T with Predicate
+//   void prepare(const kernel_settings&)     - sizes scratch buffers once per run
+//   void update_cache(T*, size_t)            - per input precomputation, not timed
+//   void sort(T*, size_t)
+// Optional:
+//   bool accepts(const T*, size_t) const     - false if kernel can't sort this input in reasonable memory or time
+// Kernels are called directly from the registry tuple, so there is no virtual dispatch.
+// 'update_cache' and 'sort' are instantiated only for supported combinations.
+
+template<typename Kernel, typename T, typename = void>
+struct has_accepts : std::false_type {};
+
+template<typename Kernel, typename T>
+struct has_accepts<Kernel, T, std::void_t<decltype(std::declval<const Kernel&>().accepts(std::declval<const T*>(), size_t{}))>> :
+    std::true_type
+{};
+
+template<typename Kernel, typename T>
+bool kernel_accepts(const Kernel& kernel, const T* array, size_t size) {
+    if constexpr (has_accepts<Kernel, T>::value) {
+        return kernel.accepts(array, size);
+    }
+    else {
+        return true;
+    }
+}
+
+// Reference implementation
+template<typename T, typename Predicate>
+class std_sort_kernel
+{
+public:
+    static constexpr std::string_view id() { return "std"; }
+    static constexpr std::string_view name() { return "std::sort"; }
+    static constexpr bool supported = true;
+
+    void prepare(const kernel_settings&) {
+
+    }
+
+    void update_cache(T*, size_t) {
+
+    }
+
+    void sort(T* array, size_t size) {
+        std::sort(array, array + size, Predicate{});
+    }
+};
+
+template<typename T, typename Predicate>
+class bubble_sort_kernel
+{
+public:
+    static constexpr std::string_view id() { return "bubble"; }
+    static constexpr std::string_view name() { return "Bubble Sort"; }
+    static constexpr bool supported = true;
+
+    // Sorting time grows as square of size: larger inputs would take hours
+    static constexpr size_t max_input_size = size_t{ 1 } << 16;
+
+    void prepare(const kernel_settings&) {
+
+    }
+
+    bool accepts(const T*, size_t size) const {
+        return size <= max_input_size;
+    }
+
+    void update_cache(T*, size_t) {
+
+    }
+
+    void sort(T* array, size_t size) {
+        sort::bubble_sort<T, Predicate>(array, size);
+    }
+};
+
+template<typename T, typename Predicate>
+class counting_sort_kernel
+{
+private:
+    using limits = std::numeric_limits<T>;
+public:
+    static constexpr std::string_view id() { return "counting"; }
+    static constexpr std::string_view name() { return "Counting Sort"; }
+    static constexpr bool supported = std::is_integral_v<T> && is_ascending_v<T, Predicate>;
+
+    // Counts array is limited to this many elements per sorted element,
+    // smaller arrays may use up to 'min_counts_size' counts
+    static constexpr size_t max_range_factor = 16;
+    static constexpr size_t min_counts_size = size_t{ 1 } << 16;
+
+    void prepare(const kernel_settings& settings) {
+        m_counts.reserve(settings.max_size + 1);
+    }
+
+    bool accepts(const T* array, size_t size) const {
+        T min = limits::max();
+        T max = limits::lowest();
+        for (size_t i = 0; i < size; ++i) {
+            min = std::min(min, array[i]);
+            max = std::max(max, array[i]);
+        }
+        return size == 0 || get_range(min, max) <= max_counts_size(size);
+    }
+
+    void update_cache(T* array, size_t size) {
+        m_min = limits::max();
+        m_max = limits::lowest();
+        for (size_t i = 0; i < size; ++i) {
+            m_min = std::min(m_min, array[i]);
+            m_max = std::max(m_max, array[i]);
+        }
+        const size_t range = size == 0 ? 0 : get_range(m_min, m_max);
+        if (range > max_counts_size(size)) {
+            throw std::runtime_error("counting sort: range of values is too wide for the input size");
+        }
+        if (m_counts.size() < range) {
+            m_counts.resize(range);
+        }
+    }
+
+    void sort(T* array, size_t size) {
+        sort::counting_sort<T>(array, get_vector_data(m_counts), size, m_min, m_max);
+    }
+
+private:
+    static size_t max_counts_size(size_t size) {
+        return std::max(size, min_counts_size / max_range_factor) * max_range_factor;
+    }
+
+    // Saturates instead of wrapping to zero on the full 64-bit range
+    static size_t get_range(T min, T max) {
+        using U = std::make_unsigned_t<T>;
+        const size_t span = static_cast<size_t>(static_cast<U>(static_cast<U>(max) - static_cast<U>(min)));
+        return span == std::numeric_limits<size_t>::max() ? span : span + 1;
+    }
+
+private:
+    T m_min{};
+    T m_max{};
+    std::vector<size_t> m_counts;
+};
+
+template<typename T, typename Predicate>
+class integer_sort_kernel
+{
+public:
+    static constexpr std::string_view id() { return "integer"; }
+    static constexpr std::string_view name() { return "Integer Sort (adaptive)"; }
+    static constexpr bool supported = std::is_integral_v<T> && is_ascending_v<T, Predicate>;
+
+    void prepare(const kernel_settings&) {
+
+    }
+
+    void update_cache(T*, size_t) {
+
+    }
+
+    void sort(T* array, size_t size) {
+        sort::integer_sort<T>(array, size, m_arena);
+    }
+
+private:
+    // Keeps scratch memory between sorts
+    sort::scratch_arena m_arena;
+};
+
+// 'max_isa' limits instruction set of sorting network base case
+template<typename T, typename Predicate, sort::simd::isa max_isa>
+class quick_sort_kernel
+{
+public:
+    static constexpr std::string_view id() {
+        return max_isa == sort::simd::isa::scalar ? "quick-scalar" : "quick";
+    }
+
+    static constexpr std::string_view name() {
+        return max_isa == sort::simd::isa::scalar ? "Quick Sort (scalar network)" : "Quick Sort";
+    }
+
+    static constexpr bool supported = true;
+
+    void prepare(const kernel_settings&) {
+
+    }
+
+    void update_cache(T*, size_t) {
+
+    }
+
+    void sort(T* array, size_t size) {
+        sort::simd::scoped_isa_limit isa_limit(max_isa);
+        sort::quick_sort<T, Predicate>(array, size);
+    }
+};
+
+template<typename T, typename Predicate>
+using quick_sort_network_kernel = quick_sort_kernel<T, Predicate, sort::simd::isa::avx2>;
+
+template<typename T, typename Predicate>
+using quick_sort_scalar_kernel = quick_sort_kernel<T, Predicate, sort::simd::isa::scalar>;
+
+// 'max_isa' limits instruction set of sorting network and merge kernels
+template<typename T, typename Predicate, sort::simd::isa max_isa>
+class merge_sort_kernel
+{
+public:
+    static constexpr std::string_view id() {
+        return max_isa == sort::simd::isa::scalar ? "merge-scalar" : "merge";
+    }
+
+    static constexpr std::string_view name() {
+        return max_isa == sort::simd::isa::scalar ? "Merge Sort (scalar network)" : "Merge Sort";
+    }
+
+    static constexpr bool supported = true;
+
+    void prepare(const kernel_settings& settings) {
+        m_cache.resize(settings.max_size);
+    }
+
+    void update_cache(T*, [[maybe_unused]] size_t size) {
+        assert(size <= m_cache.size());
+    }
+
+    void sort(T* array, size_t size) {
+        sort::simd::scoped_isa_limit isa_limit(max_isa);
+        sort::merge_sort<T, Predicate>(array, get_vector_data(m_cache), size);
+    }
+
+private:
+    std::vector<T> m_cache;
+};
+
+template<typename T, typename Predicate>
+using merge_sort_network_kernel = merge_sort_kernel<T, Predicate, sort::simd::isa::avx2>;
+
+template<typename T, typename Predicate>
+using merge_sort_scalar_kernel = merge_sort_kernel<T, Predicate, sort::simd::isa::scalar>;
+
+template<typename T, typename Predicate, size_t arity>
+class heap_sort_kernel
+{
+public:
+    static constexpr std::string_view id() {
+        if constexpr (arity == 2) {
+            return "heap-2";
+        }
+        else if constexpr (arity == 4) {
+            return "heap-4";
+        }
+        else {
+            return "heap-8";
+        }
+    }
+
+    static constexpr std::string_view name() {
+        if constexpr (arity == 2) {
+            return "Heap Sort (2-ary)";
+        }
+        else if constexpr (arity == 4) {
+            return "Heap Sort (4-ary)";
+        }
+        else {
+            return "Heap Sort (8-ary)";
+        }
+    }
+
+    static constexpr bool supported = true;
+
+    void prepare(const kernel_settings&) {
+
+    }
+
+    void update_cache(T*, size_t) {
+
+    }
+
+    void sort(T* array, size_t size) {
+        sort::heap_sort<T, Predicate, arity>(array, size);
+    }
+};
+
+template<typename T, typename Predicate>
+using heap_sort_2_kernel = heap_sort_kernel<T, Predicate, 2>;
+
+template<typename T, typename Predicate>
+using heap_sort_4_kernel = heap_sort_kernel<T, Predicate, 4>;
+
+template<typename T, typename Predicate>
+using heap_sort_8_kernel = heap_sort_kernel<T, Predicate, 8>;
+
+// Bitwise MSD and LSD sorts take the highest bit from the maximum element,
+// so they are limited to unsigned keys
+template<typename T, typename Predicate>
+class radix_sort_msd_kernel
+{
+public:
+    static constexpr std::string_view id() { return "radix-msd"; }
+    static constexpr std::string_view name() { return "Radix Sort (MSD)"; }
+    static constexpr bool supported = std::is_integral_v<T> && std::is_unsigned_v<T> &&
+        (is_ascending_v<T, Predicate> || is_descending_v<T, Predicate>);
+
+    void prepare(const kernel_settings&) {
+
+    }
+
+    void update_cache(T*, size_t) {
+
+    }
+
+    void sort(T* array, size_t size) {
+        sort::radix_sort_msd<T, is_ascending_v<T, Predicate>>(array, size);
+    }
+};
+
+template<typename T, typename Predicate>
+class radix_sort_lsd_kernel
+{
+public:
+    static constexpr std::string_view id() { return "radix-lsd"; }
+    static constexpr std::string_view name() { return "Radix Sort (LSD)"; }
+    static constexpr bool supported = std::is_integral_v<T> && std::is_unsigned_v<T> &&
+        (is_ascending_v<T, Predicate> || is_descending_v<T, Predicate>);
+
+    void prepare(const kernel_settings& settings) {
+        m_buffer.resize(settings.max_size);
+    }
+
+    void update_cache(T*, [[maybe_unused]] size_t size) {
+        assert(size <= m_buffer.size());
+    }
+
+    void sort(T* array, size_t size) {
+        sort::radix_sort_lsd<T, is_ascending_v<T, Predicate>>(array, get_vector_data(m_buffer), size);
+    }
+
+private:
+    std::vector<T> m_buffer;
+};
+
+template<typename T, typename Predicate, bool parallel>
+class radix_sort_american_flag_kernel
+{
+public:
+    static constexpr std::string_view id() {
+        return parallel ? "american-flag-parallel" : "american-flag";
+    }
+
+    static constexpr std::string_view name() {
+        return parallel ? "Radix Sort (American flag; parallel)" : "Radix Sort (American flag)";
+    }
+
+    static constexpr bool supported = std::is_integral_v<T> &&
+        (is_ascending_v<T, Predicate> || is_descending_v<T, Predicate>);
+
+    void prepare(const kernel_settings&) {
+
+    }
+
+    void update_cache(T*, size_t) {
+
+    }
+
+    void sort(T* array, size_t size) {
+        sort::radix_sort_american_flag<T, is_ascending_v<T, Predicate>>(array, size, parallel);
+    }
+};
+
+template<typename T, typename Predicate>
+using radix_sort_american_flag_serial_kernel = radix_sort_american_flag_kernel<T, Predicate, false>;
+
+template<typename T, typename Predicate>
+using radix_sort_american_flag_parallel_kernel = radix_sort_american_flag_kernel<T, Predicate, true>;
+
+// Sorts indices and then moves every element once: the way wide records are sorted
+template<typename T, typename Predicate>
+class argsort_kernel
+{
+public:
+    static constexpr std::string_view id() { return "argsort"; }
+    static constexpr std::string_view name() { return "Argsort + permutation"; }
+    static constexpr bool supported = true;
+
+    void prepare(const kernel_settings& settings) {
+        m_permutation.resize(settings.max_size);
+    }
+
+    void update_cache(T*, [[maybe_unused]] size_t size) {
+        assert(size <= m_permutation.size());
+    }
+
+    void sort(T* array, size_t size) {
+        sort::argsort(array, size, get_vector_data(m_permutation), m_arena, Predicate{});
+        sort::apply_permutation(get_vector_data(m_permutation), size, array);
+    }
+
+private:
+    std::vector<uint32_t> m_permutation;
+    sort::scratch_arena m_arena;
+};
+
+template<typename T, typename Predicate>
+class auto_sort_kernel
+{
+public:
+    static constexpr std::string_view id() { return "auto"; }
+    static constexpr std::string_view name() { return "Auto Sort"; }
+    static constexpr bool supported = true;
+
+    void prepare(const kernel_settings& settings) {
+        m_thresholds = settings.auto_sort_thresholds;
+    }
+
+    void update_cache(T*, size_t) {
+
+    }
+
+    void sort(T* array, size_t size) {
+        sort::auto_sort<T, Predicate>(array, size, m_arena, m_thresholds);
+    }
+
+private:
+    sort::auto_sort_thresholds m_thresholds;
+    sort::scratch_arena m_arena;
+};
+
+// Compile-time list of kernels, instantiated as a tuple for each element type and predicate
+template<template<typename, typename> typename... Kernels>
+struct kernel_registry
+{
+    template<typename T, typename Predicate>
+    using instance = std::tuple<Kernels<T, Predicate>...>;
+
+    template<typename Fn>
+    static void for_each_id(Fn&& fn) {
+        (fn(Kernels<uint32_t, std::less<uint32_t>>::id(), Kernels<uint32_t, std::less<uint32_t>>::name()), ...);
+    }
+};
+
+using sort_kernels = kernel_registry
+<
+    std_sort_kernel,
+    bubble_sort_kernel,
+    counting_sort_kernel,
+    integer_sort_kernel,
+    merge_sort_network_kernel,
+    merge_sort_scalar_kernel,
+    quick_sort_network_kernel,
+    quick_sort_scalar_kernel,
+    heap_sort_2_kernel,
+    heap_sort_4_kernel,
+    heap_sort_8_kernel,
+    radix_sort_msd_kernel,
+    radix_sort_lsd_kernel,
+    radix_sort_american_flag_serial_kernel,
+    radix_sort_american_flag_parallel_kernel,
+    argsort_kernel,
+    auto_sort_kernel
+>;
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string_view>
+#include <vector>
+#include "element_types.h"
+
+namespace bench
+{
+    enum class distribution
+    {
+        uniform,
+        zipf,
+        sorted,
+        reverse,
+        organ_pipe,
+        few_unique,
+        sawtooth
+    };
+
+    constexpr distribution all_distributions[] = {
+        distribution::uniform,
+        distribution::zipf,
+        distribution::sorted,
+        distribution::reverse,
+        distribution::organ_pipe,
+        distribution::few_unique,
+        distribution::sawtooth
+    };
+
+    inline std::string_view distribution_name(distribution d) {
+        switch (d) {
+        case distribution::uniform: return "uniform";
+        case distribution::zipf: return "zipf";
+        case distribution::sorted: return "sorted";
+        case distribution::reverse: return "reverse";
+        case distribution::organ_pipe: return "organ-pipe";
+        case distribution::few_unique: return "few-unique";
+        case distribution::sawtooth: return "sawtooth";
+        }
+        return "unknown";
+    }
+
+    inline bool parse_distribution(std::string_view name, distribution& out) {
+        for (distribution d : all_distributions) {
+            if (distribution_name(d) == name) {
+                out = d;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// Zipf distribution over [1, n] with P(k) ~ 1 / k^exponent.
+    /// Rejection-inversion sampling (Hormann, Derflinger) needs no tables,
+    /// so n may be as large as the collection
+    class zipf_distribution
+    {
+    public:
+        zipf_distribution(uint64_t n, double exponent = 1.0) :
+            m_n(n),
+            m_exponent(exponent)
+        {
+            m_h_integral_x1 = h_integral(1.5) - 1.0;
+            m_h_integral_n = h_integral(static_cast<double>(n) + 0.5);
+            m_s = 2.0 - h_integral_inverse(h_integral(2.5) - h(2.0));
+        }
+
+        template<typename Generator>
+        uint64_t operator()(Generator& gen) {
+            std::uniform_real_distribution<double> uniform(0.0, 1.0);
+            while (true) {
+                const double u = m_h_integral_n + uniform(gen) * (m_h_integral_x1 - m_h_integral_n);
+                const double x = h_integral_inverse(u);
+                const double k = std::clamp(std::floor(x + 0.5), 1.0, static_cast<double>(m_n));
+                if (k - x <= m_s || u >= h_integral(k + 0.5) - h(k)) {
+                    return static_cast<uint64_t>(k);
+                }
+            }
+        }
+
+    private:
+        // log(1 + x) / x, stable near zero
+        static double helper1(double x) {
+            return std::abs(x) > 1e-8 ? std::log1p(x) / x : 1.0 - x * (0.5 - x / 3.0);
+        }
+
+        // (exp(x) - 1) / x, stable near zero
+        static double helper2(double x) {
+            return std::abs(x) > 1e-8 ? std::expm1(x) / x : 1.0 + x * 0.5 * (1.0 + x / 3.0);
+        }
+
+        double h(double x) const {
+            return std::exp(-m_exponent * std::log(x));
+        }
+
+        double h_integral(double x) const {
+            const double log_x = std::log(x);
+            return helper2((1.0 - m_exponent) * log_x) * log_x;
+        }
+
+        double h_integral_inverse(double x) const {
+            const double t = std::max(-1.0, x * (1.0 - m_exponent));
+            return std::exp(helper1(t) * x);
+        }
+
+    private:
+        uint64_t m_n;
+        double m_exponent;
+        double m_h_integral_x1 = 0.0;
+        double m_h_integral_n = 0.0;
+        double m_s = 0.0;
+    };
+
+    namespace distributions_impl
+    {
+        constexpr size_t few_unique_count = 16;
+
+        inline uint64_t rank_mask(unsigned rank_bits) {
+            return rank_bits >= 64 ? ~uint64_t{ 0 } : (uint64_t{ 1 } << rank_bits) - 1;
+        }
+
+        // Spreads [0, n) over [0, mask] keeping order
+        inline uint64_t spread_rank(uint64_t i, uint64_t n, uint64_t mask) {
+            if (n <= 1) {
+                return 0;
+            }
+
+            if (n - 1 <= mask) {
+                return i * (mask / (n - 1));
+            }
+
+            return i / ((n - 1) / mask + 1);
+        }
+
+        // Bijection on [0, mask]: multiplication by odd number modulo power of two
+        inline uint64_t scatter_rank(uint64_t i, uint64_t mask) {
+            return (i * 0x9E3779B97F4A7C15ull) & mask;
+        }
+    }
+
+    /// Fills 'out' with 'size' elements of the given distribution
+    template<typename T, typename Generator>
+    void generate(distribution d, size_t size, Generator& gen, std::vector<T>& out) {
+        using namespace distributions_impl;
+        using traits = element_traits<T>;
+
+        const uint64_t mask = rank_mask(traits::rank_bits);
+        const uint64_t n = size;
+
+        out.clear();
+        out.reserve(size);
+
+        auto fill = [&](auto&& rank_of) {
+            for (uint64_t i = 0; i < n; ++i) {
+                out.push_back(traits::from_rank(rank_of(i)));
+            }
+        };
+
+        switch (d) {
+        case distribution::uniform:
+            fill([&](uint64_t) {
+                return static_cast<uint64_t>(gen()) & mask;
+            });
+            break;
+
+        case distribution::zipf: {
+            zipf_distribution zipf(std::max<uint64_t>(n, 1));
+            fill([&](uint64_t) {
+                return scatter_rank(zipf(gen) - 1, mask);
+            });
+            break;
+        }
+
+        case distribution::sorted:
+            fill([&](uint64_t i) {
+                return spread_rank(i, n, mask);
+            });
+            break;
+
+        case distribution::reverse:
+            fill([&](uint64_t i) {
+                return spread_rank(n - 1 - i, n, mask);
+            });
+            break;
+
+        case distribution::organ_pipe:
+            // Ascending first half and descending second one
+            fill([&](uint64_t i) {
+                return spread_rank(std::min(i, n - 1 - i), n, mask);
+            });
+            break;
+
+        case distribution::few_unique: {
+            std::uniform_int_distribution<uint64_t> pick(0, few_unique_count - 1);
+            fill([&](uint64_t) {
+                return scatter_rank(pick(gen), mask);
+            });
+            break;
+        }
+
+        case distribution::sawtooth: {
+            // sqrt(n) ascending runs of sqrt(n) elements
+            const uint64_t period = std::max<uint64_t>(2, static_cast<uint64_t>(std::sqrt(static_cast<double>(n))));
+            fill([&](uint64_t i) {
+                return spread_rank(i % period, period, mask);
+            });
+            break;
+        }
+        }
+    }
+}
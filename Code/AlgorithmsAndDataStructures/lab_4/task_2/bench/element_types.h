@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+namespace bench
+{
+    /// Element with key and payload, 16 bytes wide.
+    /// Only key takes part in comparison
+    struct record
+    {
+        int64_t key = 0;
+        uint64_t payload = 0;
+    };
+
+    inline bool operator<(const record& a, const record& b) {
+        return a.key < b.key;
+    }
+
+    inline bool operator>(const record& a, const record& b) {
+        return a.key > b.key;
+    }
+
+    /// Describes how generated ranks become element values.
+    /// Ranks lie in [0, 2^rank_bits) and 'from_rank' never decreases when rank grows,
+    /// so ordered ranks give ordered values and distinct ranks give distinct values
+    template<typename T>
+    struct element_traits;
+
+    template<>
+    struct element_traits<int32_t>
+    {
+        static constexpr std::string_view id = "int32";
+        static constexpr unsigned rank_bits = 32;
+        // Memory allocated outside of element itself
+        static constexpr size_t heap_bytes = 0;
+
+        static int32_t from_rank(uint64_t rank) {
+            return static_cast<int32_t>(static_cast<uint32_t>(rank) ^ 0x80000000u);
+        }
+    };
+
+    template<>
+    struct element_traits<int64_t>
+    {
+        static constexpr std::string_view id = "int64";
+        static constexpr unsigned rank_bits = 64;
+        static constexpr size_t heap_bytes = 0;
+
+        static int64_t from_rank(uint64_t rank) {
+            return static_cast<int64_t>(rank ^ (uint64_t{ 1 } << 63));
+        }
+    };
+
+    template<>
+    struct element_traits<float>
+    {
+        static constexpr std::string_view id = "float";
+        // Neighbour ranks may round to the same value
+        static constexpr unsigned rank_bits = 32;
+        static constexpr size_t heap_bytes = 0;
+
+        static float from_rank(uint64_t rank) {
+            return static_cast<float>(static_cast<int64_t>(rank) - (int64_t{ 1 } << 31));
+        }
+    };
+
+    template<>
+    struct element_traits<double>
+    {
+        static constexpr std::string_view id = "double";
+        // All ranks are exactly representable
+        static constexpr unsigned rank_bits = 53;
+        static constexpr size_t heap_bytes = 0;
+
+        static double from_rank(uint64_t rank) {
+            return static_cast<double>(static_cast<int64_t>(rank) - (int64_t{ 1 } << 52));
+        }
+    };
+
+    template<>
+    struct element_traits<std::string>
+    {
+        static constexpr std::string_view id = "string";
+        static constexpr unsigned rank_bits = 64;
+        // 20 digits don't fit small string buffer
+        static constexpr size_t heap_bytes = 32;
+
+        static std::string from_rank(uint64_t rank) {
+            // Zero padding keeps lexicographical order equal to numeric
+            char buffer[24];
+            std::snprintf(buffer, sizeof(buffer), "%020llu", static_cast<unsigned long long>(rank));
+            return buffer;
+        }
+    };
+
+    template<>
+    struct element_traits<record>
+    {
+        static constexpr std::string_view id = "struct";
+        static constexpr unsigned rank_bits = 64;
+        static constexpr size_t heap_bytes = 0;
+
+        static record from_rank(uint64_t rank) {
+            record result;
+            result.key = element_traits<int64_t>::from_rank(rank);
+            result.payload = rank;
+            return result;
+        }
+    };
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bench
+{
+    enum class result_status
+    {
+        ok,
+        // Output differs from std::sort
+        failed,
+        // Kernel rejected the input
+        skipped
+    };
+
+    inline std::string_view result_status_name(result_status status) {
+        switch (status) {
+        case result_status::ok: return "ok";
+        case result_status::failed: return "failed";
+        case result_status::skipped: return "skipped";
+        }
+        return "unknown";
+    }
+
+    struct benchmark_result
+    {
+        std::string type;
+        std::string distribution;
+        size_t size = 0;
+        std::string kernel;
+        size_t repetitions = 0;
+        double median_ns_per_element = 0.0;
+        double min_ns_per_element = 0.0;
+        result_status status = result_status::ok;
+    };
+
+    inline void write_csv(std::ostream& out, const std::vector<benchmark_result>& results) {
+        out << "type,distribution,size,kernel,repetitions,median_ns_per_element,min_ns_per_element,status\n";
+        for (const benchmark_result& r : results) {
+            out << r.type << ',' << r.distribution << ',' << r.size << ',' << r.kernel << ',' << r.repetitions << ','
+                << r.median_ns_per_element << ',' << r.min_ns_per_element << ',' << result_status_name(r.status) << '\n';
+        }
+    }
+
+    namespace report_impl
+    {
+        inline void write_json_string(std::ostream& out, std::string_view text) {
+            out << '"';
+            for (char c : text) {
+                if (c == '"' || c == '\\') {
+                    out << '\\';
+                }
+                out << c;
+            }
+            out << '"';
+        }
+    }
+
+    inline void write_json(std::ostream& out, const std::vector<benchmark_result>& results) {
+        using report_impl::write_json_string;
+
+        out << "[\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const benchmark_result& r = results[i];
+            out << "  {\"type\": ";
+            write_json_string(out, r.type);
+            out << ", \"distribution\": ";
+            write_json_string(out, r.distribution);
+            out << ", \"size\": " << r.size << ", \"kernel\": ";
+            write_json_string(out, r.kernel);
+            out << ", \"repetitions\": " << r.repetitions
+                << ", \"median_ns_per_element\": " << r.median_ns_per_element
+                << ", \"min_ns_per_element\": " << r.min_ns_per_element
+                << ", \"status\": ";
+            write_json_string(out, result_status_name(r.status));
+            out << (i + 1 == results.size() ? "}\n" : "},\n");
+        }
+        out << "]\n";
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace bench
+{
+    /// Size of installed physical memory in bytes, zero if unknown
+    inline uint64_t physical_memory_size() {
+#if defined(_WIN32)
+        MEMORYSTATUSEX status;
+        status.dwLength = sizeof(status);
+        if (!GlobalMemoryStatusEx(&status)) {
+            return 0;
+        }
+        return status.ullTotalPhys;
+#else
+        const long pages = sysconf(_SC_PHYS_PAGES);
+        const long page_size = sysconf(_SC_PAGE_SIZE);
+        if (pages <= 0 || page_size <= 0) {
+            return 0;
+        }
+        return static_cast<uint64_t>(pages) * static_cast<uint64_t>(page_size);
+#endif
+    }
+}
@@ -0,0 +1,327 @@
+// Command line sort benchmark
+// Example:
+//   aads_004_002 --types int32,string --distributions uniform,zipf --sizes 1k,1M --repetitions 5 --format json
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "command_line.h"
+#include "sort_kernels.h"
+#include "bench/distributions.h"
+#include "bench/element_types.h"
+#include "bench/report.h"
+#include "bench/system_memory.h"
+
+using element_types = type_list<int32_t, int64_t, float, double, std::string, bench::record>;
+
+struct benchmark_options
+{
+    std::vector<std::string> types = { "int32" };
+    std::vector<bench::distribution> distributions = { bench::distribution::uniform };
+    std::vector<size_t> sizes = { 1000, 100000, 1000000 };
+    std::vector<std::string> kernels = { "std", "quick", "merge", "heap-4", "american-flag", "integer", "auto" };
+    size_t repetitions = 5;
+    std::string format = "csv";
+    std::string output;
+    uint64_t seed = 0;
+    bool has_seed = false;
+    bool list = false;
+
+    bool type_selected(std::string_view id) const {
+        return list_contains(types, id) || list_contains(types, "all");
+    }
+
+    bool kernel_selected(std::string_view id) const {
+        return list_contains(kernels, id) || list_contains(kernels, "all");
+    }
+};
+
+bool parse_options(int argc, char** argv, benchmark_options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--list") {
+            options.list = true;
+            continue;
+        }
+
+        if (i + 1 == argc) {
+            return false;
+        }
+
+        const std::string_view value = argv[++i];
+        if (arg == "--types") {
+            options.types = split_list(value);
+        }
+        else if (arg == "--distributions") {
+            options.distributions.clear();
+            for (const std::string& name : split_list(value)) {
+                if (name == "all") {
+                    options.distributions.assign(std::begin(bench::all_distributions), std::end(bench::all_distributions));
+                    break;
+                }
+
+                bench::distribution d;
+                if (!bench::parse_distribution(name, d)) {
+                    std::cerr << "Unknown distribution: " << name << '\n';
+                    return false;
+                }
+                options.distributions.push_back(d);
+            }
+        }
+        else if (arg == "--sizes") {
+            options.sizes.clear();
+            for (const std::string& text : split_list(value)) {
+                uint64_t size = 0;
+                if (!parse_count(text, size) || size == 0) {
+                    std::cerr << "Bad size: " << text << '\n';
+                    return false;
+                }
+                options.sizes.push_back(static_cast<size_t>(size));
+            }
+        }
+        else if (arg == "--repetitions") {
+            uint64_t repetitions = 0;
+            if (!parse_count(value, repetitions) || repetitions == 0) {
+                return false;
+            }
+            options.repetitions = static_cast<size_t>(repetitions);
+        }
+        else if (arg == "--kernels") {
+            options.kernels = split_list(value);
+        }
+        else if (arg == "--format") {
+            options.format = value;
+            if (options.format != "csv" && options.format != "json") {
+                return false;
+            }
+        }
+        else if (arg == "--output") {
+            options.output = value;
+        }
+        else if (arg == "--seed") {
+            if (!parse_count(value, options.seed)) {
+                return false;
+            }
+            options.has_seed = true;
+        }
+        else {
+            return false;
+        }
+    }
+
+    return !options.types.empty() && !options.distributions.empty() && !options.sizes.empty() && !options.kernels.empty();
+}
+
+template<typename... Ts>
+bool validate_options(type_list<Ts...>, const benchmark_options& options) {
+    for (const std::string& type : options.types) {
+        if (type != "all" && !((type == bench::element_traits<Ts>::id) || ...)) {
+            std::cerr << "Unknown type: " << type << " (see --list)\n";
+            return false;
+        }
+    }
+
+    for (const std::string& kernel : options.kernels) {
+        bool known = kernel == "all";
+        sort_kernels::for_each_id([&](std::string_view id, std::string_view) {
+            known = known || kernel == id;
+        });
+        if (!known) {
+            std::cerr << "Unknown kernel: " << kernel << " (see --list)\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template<typename... Ts>
+void print_registry(type_list<Ts...>) {
+    std::cout << "Kernels:\n";
+    sort_kernels::for_each_id([](std::string_view id, std::string_view name) {
+        std::cout << "   " << id << " - " << name << '\n';
+    });
+    std::cout << "Types:";
+    ((std::cout << ' ' << bench::element_traits<Ts>::id), ...);
+    std::cout << "\nDistributions:";
+    for (bench::distribution d : bench::all_distributions) {
+        std::cout << ' ' << bench::distribution_name(d);
+    }
+    std::cout << '\n';
+}
+
+// Input, working copy, std::sort reference and one scratch buffer of kernels
+template<typename T>
+uint64_t required_memory(size_t size) {
+    return static_cast<uint64_t>(size) * (4 * sizeof(T) + 3 * bench::element_traits<T>::heap_bytes);
+}
+
+template<typename T>
+void run_type(const benchmark_options& options, std::mt19937_64& gen, std::vector<bench::benchmark_result>& results) {
+    using clock = std::chrono::steady_clock;
+    using predicate = std::less<T>;
+    using traits = bench::element_traits<T>;
+
+    // Leave some memory to the system
+    const uint64_t memory_limit = bench::physical_memory_size() / 10 * 9;
+
+    std::vector<size_t> sizes;
+    for (size_t size : options.sizes) {
+        if (memory_limit != 0 && required_memory<T>(size) > memory_limit) {
+            std::cerr << traits::id << ": size " << size << " skipped, it needs about "
+                << required_memory<T>(size) / (1024 * 1024) << " MB\n";
+            continue;
+        }
+        sizes.push_back(size);
+    }
+
+    if (sizes.empty()) {
+        return;
+    }
+
+    // Scratch buffers are sized once for the largest collection
+    kernel_settings settings;
+    settings.max_size = *std::max_element(sizes.begin(), sizes.end());
+
+    sort_kernels::instance<T, predicate> kernels;
+    auto for_each_selected = [&](auto&& fn) {
+        std::apply([&](auto&... kernel) {
+            auto visit = [&](auto& k) {
+                using kernel_t = std::decay_t<decltype(k)>;
+                if constexpr (kernel_t::supported) {
+                    if (options.kernel_selected(kernel_t::id())) {
+                        fn(k);
+                    }
+                }
+            };
+            (visit(kernel), ...);
+        }, kernels);
+    };
+
+    for_each_selected([&](auto& kernel) {
+        kernel.prepare(settings);
+    });
+
+    std::vector<T> input;
+    std::vector<T> reference;
+    std::vector<T> work;
+    std::vector<double> times;
+
+    auto equivalent = [](const T& a, const T& b) {
+        return !predicate{}(a, b) && !predicate{}(b, a);
+    };
+
+    for (bench::distribution d : options.distributions) {
+        for (size_t size : sizes) {
+            bench::generate(d, size, gen, input);
+            reference = input;
+            std::sort(reference.begin(), reference.end(), predicate{});
+
+            for_each_selected([&](auto& kernel) {
+                bench::benchmark_result result;
+                result.type = traits::id;
+                result.distribution = bench::distribution_name(d);
+                result.size = size;
+                result.kernel = kernel.id();
+                result.repetitions = options.repetitions;
+
+                if (!kernel_accepts(kernel, input.data(), input.size())) {
+                    result.status = bench::result_status::skipped;
+                    results.push_back(result);
+                    std::cerr << result.type << ' ' << result.distribution << ' ' << size << ' ' << result.kernel << ": skipped\n";
+                    return;
+                }
+
+                times.clear();
+                for (size_t r = 0; r < options.repetitions; ++r) {
+                    work = input;
+                    kernel.update_cache(get_vector_data(work), work.size());
+
+                    const auto t1 = clock::now();
+                    kernel.sort(get_vector_data(work), work.size());
+                    const auto t2 = clock::now();
+
+                    const std::chrono::duration<double, std::nano> elapsed = t2 - t1;
+                    times.push_back(elapsed.count() / static_cast<double>(size));
+
+                    if (!std::equal(work.begin(), work.end(), reference.begin(), equivalent)) {
+                        result.status = bench::result_status::failed;
+                    }
+                }
+
+                // Even count of repetitions: mean of the two middle times
+                std::sort(times.begin(), times.end());
+                const size_t middle = times.size() / 2;
+                result.median_ns_per_element = times.size() % 2 != 0 ? times[middle] : (times[middle - 1] + times[middle]) / 2;
+                result.min_ns_per_element = times.front();
+                results.push_back(result);
+
+                std::cerr << result.type << ' ' << result.distribution << ' ' << size << ' ' << result.kernel << ": "
+                    << result.median_ns_per_element << " ns/element" << (result.status == bench::result_status::failed ? " FAILED" : "") << '\n';
+            });
+        }
+    }
+}
+
+template<typename... Ts>
+void run_selected(type_list<Ts...>, const benchmark_options& options, std::mt19937_64& gen, std::vector<bench::benchmark_result>& results) {
+    auto run = [&](std::string_view type_name, auto type) {
+        if (options.type_selected(type_name)) {
+            run_type<typename decltype(type)::type>(options, gen, results);
+        }
+    };
+    (run(bench::element_traits<Ts>::id, type_tag<Ts>{}), ...);
+}
+
+int main(int argc, char** argv) {
+    benchmark_options options;
+    if (!parse_options(argc, argv, options)) {
+        std::cerr << "Usage: " << argv[0] << " [--list]"
+            << " [--types t1,t2|all] [--distributions d1,d2|all] [--sizes n1,n2 (k/M/G suffixes)]"
+            << " [--repetitions n] [--kernels k1,k2|all] [--format csv|json] [--output file] [--seed n]\n";
+        return 1;
+    }
+
+    if (options.list) {
+        print_registry(element_types{});
+        return 0;
+    }
+
+    if (!validate_options(element_types{}, options)) {
+        return 1;
+    }
+
+    std::mt19937_64 gen(options.has_seed ? options.seed : std::random_device{}());
+
+    std::vector<bench::benchmark_result> results;
+    run_selected(element_types{}, options, gen, results);
+
+    std::ofstream file;
+    if (!options.output.empty()) {
+        file.open(options.output);
+        if (!file) {
+            std::cerr << "Can't open " << options.output << '\n';
+            return 1;
+        }
+    }
+
+    std::ostream& out = options.output.empty() ? std::cout : file;
+    if (options.format == "json") {
+        bench::write_json(out, results);
+    }
+    else {
+        bench::write_csv(out, results);
+    }
+
+    const bool all_valid = std::none_of(results.begin(), results.end(), [](const bench::benchmark_result& r) {
+        return r.status == bench::result_status::failed;
+    });
+    return all_valid ? 0 : 2;
+}
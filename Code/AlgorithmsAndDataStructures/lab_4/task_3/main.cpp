@@ -0,0 +1,209 @@
+// External merge sort of binary files with fixed-width keys
+// Examples:
+//   aads_004_003 generate keys.bin 1G --type uint64
+//   aads_004_003 sort keys.bin sorted.bin --type uint64 --memory 1024 --threads 8
+//   aads_004_003 verify sorted.bin --type uint64
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "command_line.h"
+#include "sort/external_sort.h"
+
+struct tool_options
+{
+    std::string command;
+    std::vector<std::string> paths;
+    std::string type = "uint64";
+    uint64_t count = 0;
+    uint64_t seed = 0;
+    bool has_seed = false;
+    sort::external_sort_options sort_options;
+};
+
+bool parse_options(int argc, char** argv, tool_options& options) {
+    if (argc < 2) {
+        return false;
+    }
+
+    options.command = argv[1];
+    for (int i = 2; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg.substr(0, 2) != "--") {
+            options.paths.emplace_back(arg);
+            continue;
+        }
+
+        if (i + 1 == argc) {
+            return false;
+        }
+
+        const std::string_view value = argv[++i];
+        uint64_t number = 0;
+        if (arg == "--type") {
+            options.type = value;
+        }
+        else if (arg == "--temp") {
+            options.sort_options.temp_directory = std::string(value);
+        }
+        else if (!parse_count(value, number)) {
+            return false;
+        }
+        else if (arg == "--memory") {
+            options.sort_options.memory_budget = static_cast<size_t>(number) << 20;
+        }
+        else if (arg == "--block") {
+            options.sort_options.io_block_size = static_cast<size_t>(number) << 10;
+        }
+        else if (arg == "--threads") {
+            options.sort_options.threads_count = static_cast<size_t>(number);
+        }
+        else if (arg == "--seed") {
+            options.seed = number;
+            options.has_seed = true;
+        }
+        else {
+            return false;
+        }
+    }
+
+    if (options.command == "generate") {
+        // Count is the second positional argument
+        if (options.paths.size() != 2 || !parse_count(options.paths[1], options.count)) {
+            return false;
+        }
+        options.paths.pop_back();
+        return true;
+    }
+
+    if (options.command == "sort") {
+        return options.paths.size() == 2;
+    }
+
+    return options.command == "verify" && options.paths.size() == 1;
+}
+
+template<typename T>
+void generate(const tool_options& options) {
+    using clock = std::chrono::steady_clock;
+    constexpr size_t block_elements = size_t{ 1 } << 16;
+
+    std::mt19937_64 gen(options.has_seed ? options.seed : std::random_device{}());
+    std::vector<T> block(block_elements);
+
+    const auto start = clock::now();
+    sort::external_sort_impl::file_handle file(options.paths[0], "wb");
+    for (uint64_t written = 0; written < options.count;) {
+        const size_t count = static_cast<size_t>(std::min<uint64_t>(block_elements, options.count - written));
+        for (size_t i = 0; i < count; ++i) {
+            if constexpr (std::is_floating_point_v<T>) {
+                block[i] = static_cast<T>(static_cast<int64_t>(gen()));
+            }
+            else {
+                block[i] = static_cast<T>(gen());
+            }
+        }
+        if (std::fwrite(block.data(), sizeof(T), count, file.get()) != count) {
+            throw std::runtime_error("can't write " + options.paths[0]);
+        }
+        written += count;
+    }
+    file.close();
+
+    const std::chrono::duration<double> elapsed = clock::now() - start;
+    std::cout << "Generated " << options.count << " elements in " << elapsed.count() << " s\n";
+}
+
+template<typename T>
+void external_sort(const tool_options& options) {
+    const sort::external_sort_statistics statistics =
+        sort::external_sort<T>(options.paths[0], options.paths[1], options.sort_options);
+
+    std::cout << "Sorted " << statistics.bytes / (1024 * 1024) << " MB\n";
+    std::cout << "   runs: " << statistics.runs_count << '\n';
+    std::cout << "   merge passes: " << statistics.merge_passes << '\n';
+    std::cout << "   run formation: " << statistics.run_formation_seconds << " s\n";
+    std::cout << "   merge: " << statistics.merge_seconds << " s\n";
+    std::cout << "   throughput: " << statistics.throughput() << " MB/s\n";
+}
+
+// Returns false if file is not sorted
+template<typename T>
+bool verify(const tool_options& options) {
+    constexpr size_t block_elements = size_t{ 1 } << 16;
+
+    std::vector<T> block(block_elements);
+    sort::external_sort_impl::file_handle file(options.paths[0], "rb");
+    uint64_t total = 0;
+    T previous{};
+    while (true) {
+        const size_t count = std::fread(block.data(), sizeof(T), block.size(), file.get());
+        for (size_t i = 0; i < count; ++i, ++total) {
+            if (total != 0 && block[i] < previous) {
+                std::cout << "Not sorted at element " << total << '\n';
+                return false;
+            }
+            previous = block[i];
+        }
+        if (count < block.size()) {
+            break;
+        }
+    }
+
+    std::cout << "Sorted, " << total << " elements\n";
+    return true;
+}
+
+template<typename T>
+int run(const tool_options& options) {
+    if (options.command == "generate") {
+        generate<T>(options);
+        return 0;
+    }
+
+    if (options.command == "sort") {
+        external_sort<T>(options);
+        return 0;
+    }
+
+    return verify<T>(options) ? 0 : 2;
+}
+
+int main(int argc, char** argv) {
+    tool_options options;
+    if (!parse_options(argc, argv, options)) {
+        std::cerr << "Usage:\n"
+            << "   " << argv[0] << " generate <file> <count (k/M/G suffixes)> [--type t] [--seed n]\n"
+            << "   " << argv[0] << " sort <input> <output> [--type t] [--memory MB] [--block KB] [--threads n] [--temp dir]\n"
+            << "   " << argv[0] << " verify <file> [--type t]\n"
+            << "Types: uint32, uint64, int64, double\n";
+        return 1;
+    }
+
+    try {
+        if (options.type == "uint32") {
+            return run<uint32_t>(options);
+        }
+        if (options.type == "uint64") {
+            return run<uint64_t>(options);
+        }
+        if (options.type == "int64") {
+            return run<int64_t>(options);
+        }
+        if (options.type == "double") {
+            return run<double>(options);
+        }
+        std::cerr << "Unknown type: " << options.type << '\n';
+        return 1;
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+// Separate chaining without per node allocations: all entries live in one contiguous array
+// in insertion order and chains link them by 32 bit indices, buckets only hold the index of
+// the chain head. Bucket count is a power of two and doubles when the load factor would exceed
+// the maximum; rehash relinks the chains and never moves entries.
+template
+<
+    typename Key,
+    typename Value,
+    typename Hasher
+>
+class ChainedHashMap
+{
+private:
+    using Index = uint32_t;
+
+    struct Entry
+    {
+        Key key;
+        Value value;
+        Index next;
+    };
+
+    static constexpr Index NoEntry = std::numeric_limits<Index>::max();
+    static constexpr size_t MinBucketsCount = 8;
+
+public:
+    static constexpr float DefaultMaxLoadFactor = 1.f;
+
+    /// Buckets count is rounded up to a power of two
+    ChainedHashMap(size_t bucketsCount = MinBucketsCount) {
+        Rehash(RoundUpBucketsCount(bucketsCount));
+    }
+
+    /// Returns nullptr if key is already in map.
+    /// Returned pointer is valid until the next insertion: the entries array may reallocate
+    template<typename... Args>
+    Value* Emplace(Key key, Args&&... args) {
+        size_t bucket = GetBucketIndex(key);
+        if (FindEntry(bucket, key) != NoEntry) {
+            return nullptr;
+        }
+
+        assert(m_entries.size() < NoEntry);
+        if (static_cast<float>(m_entries.size() + 1) > m_maxLoadFactor * static_cast<float>(m_buckets.size())) {
+            Rehash(m_buckets.size() * 2);
+            bucket = GetBucketIndex(key);
+        }
+
+        m_entries.push_back(Entry{ std::move(key), Value(std::forward<Args>(args)...), m_buckets[bucket] });
+        m_buckets[bucket] = static_cast<Index>(m_entries.size() - 1);
+        return &m_entries.back().value;
+    }
+
+    Value* Find(const Key& key) {
+        const Index index = FindEntry(GetBucketIndex(key), key);
+        return index != NoEntry ? &m_entries[index].value : nullptr;
+    }
+
+    const Value* Find(const Key& key) const {
+        const Index index = FindEntry(GetBucketIndex(key), key);
+        return index != NoEntry ? &m_entries[index].value : nullptr;
+    }
+
+    /// Makes space for 'count' elements: no reallocation or rehash until it is exceeded
+    void Reserve(size_t count) {
+        m_entries.reserve(count);
+        size_t bucketsCount = m_buckets.size();
+        while (m_maxLoadFactor * static_cast<float>(bucketsCount) < static_cast<float>(count)) {
+            bucketsCount *= 2;
+        }
+
+        if (bucketsCount != m_buckets.size()) {
+            Rehash(bucketsCount);
+        }
+    }
+
+    /// Mean chain length the table grows at
+    void SetMaxLoadFactor(float maxLoadFactor) {
+        assert(maxLoadFactor > 0.f);
+        m_maxLoadFactor = maxLoadFactor;
+        Reserve(m_entries.size());
+    }
+
+    float GetMaxLoadFactor() const {
+        return m_maxLoadFactor;
+    }
+
+    float GetLoadFactor() const {
+        return static_cast<float>(m_entries.size()) / static_cast<float>(m_buckets.size());
+    }
+
+    size_t GetSize() const {
+        return m_entries.size();
+    }
+
+    size_t GetBucketsCount() const {
+        return m_buckets.size();
+    }
+
+private:
+    // Hasher gives full width hash, multiplicative mix spreads it over the low bits taken by mask
+    size_t GetBucketIndex(const Key& key) const {
+        const uint64_t mixed = static_cast<uint64_t>(m_hasher(key)) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(mixed ^ (mixed >> 32)) & (m_buckets.size() - 1);
+    }
+
+    Index FindEntry(size_t bucket, const Key& key) const {
+        Index index = m_buckets[bucket];
+        while (index != NoEntry && !(m_entries[index].key == key)) {
+            index = m_entries[index].next;
+        }
+        return index;
+    }
+
+    static size_t RoundUpBucketsCount(size_t bucketsCount) {
+        size_t powerOfTwo = MinBucketsCount;
+        while (powerOfTwo < bucketsCount) {
+            powerOfTwo *= 2;
+        }
+        return powerOfTwo;
+    }
+
+    void Rehash(size_t bucketsCount) {
+        m_buckets.assign(bucketsCount, NoEntry);
+        for (size_t i = 0; i < m_entries.size(); ++i) {
+            Entry& entry = m_entries[i];
+            const size_t bucket = GetBucketIndex(entry.key);
+            entry.next = m_buckets[bucket];
+            m_buckets[bucket] = static_cast<Index>(i);
+        }
+    }
+
+private:
+    Hasher m_hasher;
+    float m_maxLoadFactor = DefaultMaxLoadFactor;
+    std::vector<Index> m_buckets;
+    std::vector<Entry> m_entries;
+};
@@ -8,62 +8,28 @@
 #include <random>
 #include <vector>
 
+#include "ChainedHashMap.h"
 #include "ClosedHashMap.h"
+#include "Hashers.h"
 #include "OpenHashMap.h"
 
-template
-<
-    typename T,
-    typename Enable = std::enable_if_t<std::is_integral_v<T>>
->
-struct KnuthMultiplicativeMethod {
-    size_t operator()(T key, size_t bytes) const {
-        assert(bytes <= sizeof(key));
-        const size_t bits = bytes * 8;
-        return (key * T{ 2654435761 }) % (T{ 1 } << bits);
-    }
-
-    size_t operator()(T key) const {
-        constexpr size_t bytes = 2;
-        constexpr size_t bits = bytes * 8;
-        assert(bytes <= sizeof(key));
-        return (key * T{ 2654435761 }) % (T{ 1 } << bits);
-    }
-};
-
-template
-<
-    typename T,
-    typename Enable = std::enable_if_t<std::is_integral_v<T>>
->
-struct FirstNBitsHasher {
-    size_t operator()(T key, size_t bytes) const {
-        assert(bytes <= sizeof(key));
-        T result = 0;
-        std::memcpy(&result, &key, bytes);
-        return result;
-    }
-
-    size_t operator()(T key) const {
-        T result = 0;
-        constexpr size_t bytes = 2;
-        assert(bytes <= sizeof(key));
-        std::memcpy(&result, &key, bytes);
-        return result;
-    }
-};
-
 #ifdef _DEBUG
 constexpr bool validateHashMap = true;
 #else
 constexpr bool validateHashMap = false;
 #endif
 
+// Sorted vector buckets with Knuth and first n bits hashing, chained map with contiguous entries,
+// batched lookups of sorted vector buckets (find only)
+constexpr size_t mapsCount = 3;
+
 int main(int, char**) {
     using T = double;
     using Duration = std::chrono::nanoseconds;
     using DurationU = long double;
     using Clock = std::chrono::high_resolution_clock;
+    using AddDurations = std::array<DurationU, mapsCount>;
+    using FindDurations = std::array<DurationU, mapsCount + 1>;
 
     constexpr size_t valuesCount = 100000;
     constexpr size_t stepsCount = 200;
@@ -143,8 +109,8 @@ int main(int, char**) {
         return static_cast<DurationU>(std::chrono::duration_cast<Duration>(t2 - t1).count());
     };
 
-    std::vector<std::vector<std::pair<DurationU, DurationU>>> addDurations(passesCount);
-    std::vector<std::vector<std::pair<DurationU, DurationU>>> findDurations(passesCount);
+    std::vector<std::vector<AddDurations>> addDurations(passesCount);
+    std::vector<std::vector<FindDurations>> findDurations(passesCount);
     for (size_t pass = 0; pass < passesCount; ++pass) {
         std::vector<std::pair<size_t, T>> pairs;
         std::uniform_int_distribution<size_t> keyDistribution(keyMinValues[pass], keyMaxValues[pass]);
@@ -174,6 +140,8 @@ int main(int, char**) {
 
         OpenHashMap<size_t, T, KnuthMultiplicativeMethod<size_t>> map_a(maxBucketsCount);
         OpenHashMap<size_t, T, FirstNBitsHasher<size_t>> map_b(maxBucketsCount);
+        // Starts small and grows with the elements
+        ChainedHashMap<size_t, T, KnuthMultiplicativeMethod<size_t>> map_c;
         auto& passEmplaceDurations = addDurations[pass];
         auto& passFindDurations = findDurations[pass];
         for (size_t step = 0; step < stepsCount; ++step) {
@@ -213,7 +181,8 @@ int main(int, char**) {
 
                 auto duration_a = profileAdd(map_a) / valuesPerStep;
                 auto duration_b = profileAdd(map_b) / valuesPerStep;
-                passEmplaceDurations.push_back(std::pair{ duration_a, duration_b });
+                auto duration_c = profileAdd(map_c) / valuesPerStep;
+                passEmplaceDurations.push_back(AddDurations{ duration_a, duration_b, duration_c });
             }
 
             {
@@ -230,39 +199,56 @@ int main(int, char**) {
 
                 auto duration_a = profileFind(map_a) / valuesPerStep;
                 auto duration_b = profileFind(map_b) / valuesPerStep;
-                passFindDurations.push_back(std::pair{ duration_a, duration_b });
+                auto duration_c = profileFind(map_c) / valuesPerStep;
+
+                std::vector<size_t> keys(valuesPerStep);
+                std::vector<T*> values(valuesPerStep);
+                for (size_t i = pairsBegin; i < pairsEnd; ++i) {
+                    keys[i - pairsBegin] = pairs[i].first;
+                }
+                auto duration_d = getExecutionTime([&]() {
+                    map_a.FindBatch(keys.data(), keys.size(), values.data());
+                }) / valuesPerStep;
+                if constexpr (validateHashMap) {
+                    for (size_t i = pairsBegin; i < pairsEnd; ++i) {
+                        if (values[i - pairsBegin] != map_a.Find(pairs[i].first)) {
+                            throw std::runtime_error("Batched lookup differs from single one");
+                        }
+                    }
+                }
+                passFindDurations.push_back(FindDurations{ duration_a, duration_b, duration_c, duration_d });
             }
         }
     }
 
-    auto showResults = [&](std::vector<std::vector<std::pair<DurationU, DurationU>>>& durations) {
+    auto showResults = [&](const auto& durations) {
         for (size_t step = 0; step < durations.front().size(); ++step) {
-            auto getMean = [&](DurationU std::pair<DurationU, DurationU>::*pMember) {
+            auto getMean = [&](size_t map) {
                 long double sum = 0;
                 for (size_t pass = 0; pass < passesCount; ++pass) {
-                    const auto& durationsPair = durations[pass][step];
-                    const DurationU duration = (durationsPair.*pMember);
-                    sum += duration;
+                    sum += durations[pass][step][map];
                 }
                 return (sum / passesCount);
             };
 
-            auto mean_a = getMean(&std::pair<DurationU, DurationU>::first);
-            auto mean_b = getMean(&std::pair<DurationU, DurationU>::second);
-            println(valuesPerStep * step, split, mean_a, split, mean_b);
+            print(valuesPerStep * step);
+            for (size_t map = 0; map < durations.front()[step].size(); ++map) {
+                print(split, getMean(map));
+            }
+            println();
         }
     };
 
     {
         println("Adding new elements to hash table");
-        println("Elements count", split, "Knuth hashing", split, "First n bits hashing");
+        println("Elements count", split, "Knuth hashing", split, "First n bits hashing", split, "Chained (contiguous entries)");
         showResults(addDurations);
         println();
     }
 
     {
         println("Find existing elements");
-        println("Elements count", split, "Knuth hashing", split, "First n bits hashing");
+        println("Elements count", split, "Knuth hashing", split, "First n bits hashing", split, "Chained (contiguous entries)", split, "Knuth hashing, batched");
         showResults(findDurations);
         println();
     }
@@ -1,10 +1,21 @@
 #pragma once
 
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "HashMapStatistics.h"
+#include "Prefetch.h"
+
 struct LinearProbingCollisionPolicy
 {
+    static constexpr bool RobinHood = false;
+    static constexpr float MaxLoadFactor = 1.f;
+
     size_t operator()(size_t i, size_t hash) const {
         return hash + i;
     }
@@ -14,8 +25,13 @@ struct LinearProbingCollisionPolicy
     }
 };
 
+// Capacities are primes: probe sequence visits (p + 1) / 2 distinct slots,
+// so a table at most half full always has a free slot on it
 struct QuadraticProbingCollisionPolicy
 {
+    static constexpr bool RobinHood = false;
+    static constexpr float MaxLoadFactor = 0.5f;
+
     size_t operator()(size_t i, size_t hash) const {
         return hash + i * i;
     }
@@ -30,7 +46,7 @@ struct QuadraticProbingCollisionPolicy
 
 private:
     static bool IsPrime(size_t value) {
-        for (size_t i = 2; i <= value / 2; i++) {
+        for (size_t i = 2; i * i <= value; i++) {
             if (value % i == 0) {
                 return false;
             }
@@ -40,14 +56,119 @@ private:
     }
 };
 
+// Linear probing where an inserted element takes the slot of an element closer to its home slot.
+// Distances from home slots stay nondecreasing along the probe path, so variance of probe lengths is low,
+// lookup of a missing key stops at the first element closer to home than the probe,
+// and erase shifts the following elements back instead of leaving a tombstone
+struct RobinHoodCollisionPolicy
+{
+    static constexpr bool RobinHood = true;
+    static constexpr float MaxLoadFactor = 1.f;
+
+    size_t operator()(size_t i, size_t hash) const {
+        return hash + i;
+    }
+
+    size_t AdjustCapacity(size_t capacity) const {
+        return capacity;
+    }
+};
+
+/// Probes made by successful lookups of all stored elements
+struct ProbeStatistics
+{
+    double meanLength = 0;
+    size_t maxLength = 0;
+};
+
+// Key of a slot with its metadata and the value are stored side by side:
+// the found value is on the key's cache line, but probing loads values of all visited slots
+struct InterleavedLayout
+{
+    template<typename KeySlot, typename Value>
+    class Table
+    {
+    private:
+        struct Slot
+        {
+            KeySlot keySlot;
+            Value value;
+        };
+
+    public:
+        Table() = default;
+
+        Table(size_t capacity, const KeySlot& emptySlot) :
+            m_slots(capacity, Slot{ emptySlot, Value{} })
+        {}
+
+        size_t GetCapacity() const {
+            return m_slots.size();
+        }
+
+        KeySlot& GetKeySlot(size_t index) {
+            return m_slots[index].keySlot;
+        }
+
+        const KeySlot& GetKeySlot(size_t index) const {
+            return m_slots[index].keySlot;
+        }
+
+        Value& GetValue(size_t index) {
+            return m_slots[index].value;
+        }
+
+    private:
+        std::vector<Slot> m_slots;
+    };
+};
+
+// Keys with their metadata and values are stored in separate arrays (structure of arrays):
+// probing scans dense lines of keys and loads only the value of the found element
+struct SplitLayout
+{
+    template<typename KeySlot, typename Value>
+    class Table
+    {
+    public:
+        Table() = default;
+
+        Table(size_t capacity, const KeySlot& emptySlot) :
+            m_keySlots(capacity, emptySlot),
+            m_values(capacity)
+        {}
+
+        size_t GetCapacity() const {
+            return m_keySlots.size();
+        }
+
+        KeySlot& GetKeySlot(size_t index) {
+            return m_keySlots[index];
+        }
+
+        const KeySlot& GetKeySlot(size_t index) const {
+            return m_keySlots[index];
+        }
+
+        Value& GetValue(size_t index) {
+            return m_values[index];
+        }
+
+    private:
+        std::vector<KeySlot> m_keySlots;
+        std::vector<Value> m_values;
+    };
+};
+
 template
 <
     typename Key,
     typename Value,
     typename Hasher,
-    typename CollisionPolicy = LinearProbingCollisionPolicy
+    typename CollisionPolicy = LinearProbingCollisionPolicy,
+    typename Layout = InterleavedLayout
 >
-class ClosedHashMap
+class ClosedHashMap : private HashMapStatisticsHolder<HashMapStatisticsRecorder>
 {
 private:
     struct Hash
@@ -55,81 +176,388 @@ private:
         size_t value;
     };
 
-    struct TableElement
+    struct KeySlot
     {
         Key key;
-        Value value;
         bool has_value : 1;
+        // Tombstone of an erased element: probing continues past it, insertion may reuse it
+        bool deleted : 1;
+        // Collision index of the slot: distance from home slot
+        uint32_t distance;
     };
-public:
 
-    ClosedHashMap(size_t hashSize) :
-        m_hashSize(hashSize)
+    // Element out of the table: carried by Robin Hood insertion and rehash
+    struct TableElement
     {
-        UpdateCapacity();
+        KeySlot keySlot;
+        Value value;
+    };
+
+    using Table = typename Layout::template Table<KeySlot, Value>;
+
+    static constexpr size_t NoIndex = std::numeric_limits<size_t>::max();
+
+public:
+
+    static constexpr float DefaultMaxLoadFactor = 0.75f;
+    /// Share of tombstones in the table which makes erase drop them all
+    static constexpr float MaxTombstonesRatio = 0.25f;
+
+    /// Initial capacity is 256^hashSize slots (adjusted by collision policy)
+    ClosedHashMap(size_t hashSize) {
+        Rehash(ComputeCapacity(hashSize));
     }
 
+    /// Grows table when load factor would exceed the maximum, so it never runs out of slots.
+    /// Tombstones count as taken slots: when they are the reason to grow and live elements
+    /// take less than half of the allowed slots, tombstones are dropped instead.
+    /// The key must not be in the map
     template<typename... Args>
     Value* Emplace(Key key, Args&&... args) {
-        if (m_size < m_table.size()) {
-            const Hash hash = GetHash(key);
-            for (size_t collisionIndex = 0; collisionIndex < m_table.size(); ++collisionIndex) {
-                const size_t tableIndex = HashToTableIndex(collisionIndex, hash);
-                TableElement& tableElement = m_table[tableIndex];
-                if (!tableElement.has_value) {
-                    tableElement.has_value = true;
-                    tableElement.key = key;
-                    new (&tableElement.value) Value(std::forward<Args>(args)...);
-                    ++m_size;
-                    return &tableElement.value;
-                }
-
-                assert(tableElement.key != key);
+        const float maxElements = m_maxLoadFactor * static_cast<float>(m_table.GetCapacity());
+        if (static_cast<float>(m_size + m_tombstones + 1) > maxElements) {
+            if (m_tombstones != 0 && static_cast<float>(2 * (m_size + 1)) <= maxElements) {
+                RehashInPlace();
             }
+            else {
+                Rehash(GrowCapacity(m_table.GetCapacity()));
+            }
+        }
+
+        const Hash hash = GetHash(key);
+        if constexpr (CollisionPolicy::RobinHood) {
+            TableElement element{ KeySlot{ std::move(key), true, false, 0 }, Value(std::forward<Args>(args)...) };
+            ++m_size;
+            size_t probes = 0;
+            const size_t index = InsertRobinHood(std::move(element), hash, probes);
+            GetStatisticsRecorder().RecordProbes(HashMapOperation::Emplace, probes);
+            return &m_table.GetValue(index);
         }
+        else {
+            uint32_t distance = 0;
+            size_t index = FindFreeIndex(hash, distance, &key);
+            while (index == NoIndex) {
+                // Probe sequence may not visit every slot (quadratic probing)
+                Rehash(GrowCapacity(m_table.GetCapacity()));
+                index = FindFreeIndex(hash, distance, &key);
+            }
 
-        return nullptr;
+            KeySlot& keySlot = m_table.GetKeySlot(index);
+            if (keySlot.deleted) {
+                keySlot.deleted = false;
+                --m_tombstones;
+            }
+            keySlot.has_value = true;
+            keySlot.distance = distance;
+            keySlot.key = std::move(key);
+            Value& value = m_table.GetValue(index);
+            value = Value(std::forward<Args>(args)...);
+            ++m_size;
+            GetStatisticsRecorder().RecordProbes(HashMapOperation::Emplace, size_t{ distance } + 1);
+            return &value;
+        }
     }
 
     Value* Find(const Key& key) {
-        TableElement* element = FindElement(key);
-        return element ? &element->value : nullptr;
+        const size_t index = FindIndex(key, GetHash(key));
+        return index != NoIndex ? &m_table.GetValue(index) : nullptr;
+    }
+
+    /// Sets values[i] to the value of keys[i] or nullptr.
+    /// Home slots of a group of keys are prefetched before any of them is probed,
+    /// so cache misses of the group overlap instead of following one another
+    void FindBatch(const Key* keys, size_t count, Value** values) {
+        Hash hashes[PrefetchGroupSize];
+        for (size_t groupBegin = 0; groupBegin < count; groupBegin += PrefetchGroupSize) {
+            const size_t groupSize = std::min(PrefetchGroupSize, count - groupBegin);
+            for (size_t i = 0; i < groupSize; ++i) {
+                hashes[i] = GetHash(keys[groupBegin + i]);
+                Prefetch(&m_table.GetKeySlot(HashToTableIndex(0, hashes[i])));
+            }
+
+            for (size_t i = 0; i < groupSize; ++i) {
+                const size_t index = FindIndex(keys[groupBegin + i], hashes[i]);
+                values[groupBegin + i] = index != NoIndex ? &m_table.GetValue(index) : nullptr;
+            }
+        }
+    }
+
+    /// Robin Hood probing uses backward shift deletion: following elements of the cluster move
+    /// one slot closer to home. Other policies leave a tombstone, which are all dropped
+    /// by rehash in place when they exceed MaxTombstonesRatio of the table.
+    /// Returns false if key is not in map
+    bool Erase(const Key& key) {
+        size_t index = FindIndex(key, GetHash(key), HashMapOperation::Erase);
+        if (index == NoIndex) {
+            return false;
+        }
+
+        if constexpr (CollisionPolicy::RobinHood) {
+            for (size_t next = NextIndex(index); IsShiftable(next); next = NextIndex(next)) {
+                MoveElement(index, next);
+                --m_table.GetKeySlot(index).distance;
+                index = next;
+            }
+
+            m_table.GetKeySlot(index).has_value = false;
+            --m_size;
+        }
+        else {
+            MakeTombstone(index);
+            if (static_cast<float>(m_tombstones) > MaxTombstonesRatio * static_cast<float>(m_table.GetCapacity())) {
+                RehashInPlace();
+            }
+        }
+        return true;
+    }
+
+    /// Erases elements for which 'predicate(key, value)' is true, returns their count
+    template<typename Predicate>
+    size_t EraseIf(Predicate predicate) {
+        const size_t size = m_size;
+        for (size_t index = 0; index < m_table.GetCapacity(); ++index) {
+            const KeySlot& keySlot = m_table.GetKeySlot(index);
+            if (keySlot.has_value && predicate(keySlot.key, m_table.GetValue(index))) {
+                MakeTombstone(index);
+            }
+        }
+
+        if constexpr (CollisionPolicy::RobinHood) {
+            // Robin Hood probing can't have holes in clusters: remaining elements are reinserted
+            if (m_size != size) {
+                Rehash(m_table.GetCapacity());
+            }
+        }
+        else if (static_cast<float>(m_tombstones) > MaxTombstonesRatio * static_cast<float>(m_table.GetCapacity())) {
+            RehashInPlace();
+        }
+        return size - m_size;
+    }
+
+    ProbeStatistics GetProbeStatistics() const {
+        ProbeStatistics statistics;
+        size_t total = 0;
+        for (size_t index = 0; index < m_table.GetCapacity(); ++index) {
+            const KeySlot& keySlot = m_table.GetKeySlot(index);
+            if (keySlot.has_value) {
+                const size_t length = size_t{ keySlot.distance } + 1;
+                total += length;
+                statistics.maxLength = std::max(statistics.maxLength, length);
+            }
+        }
+
+        if (m_size != 0) {
+            statistics.meanLength = static_cast<double>(total) / static_cast<double>(m_size);
+        }
+        return statistics;
+    }
+
+    /// Longest run of adjacent taken slots (elements and tombstones), the table wraps around.
+    /// Linear probing walks whole clusters, so they show why it degrades at high load
+    size_t GetMaxClusterLength() const {
+        const size_t capacity = m_table.GetCapacity();
+        auto isTaken = [&](size_t index) {
+            const KeySlot& keySlot = m_table.GetKeySlot(index);
+            return keySlot.has_value || keySlot.deleted;
+        };
+
+        // Start after a free slot so a cluster wrapping around the end is counted once
+        size_t start = 0;
+        while (start < capacity && isTaken(start)) {
+            ++start;
+        }
+        if (start == capacity) {
+            return capacity;
+        }
+
+        size_t maxLength = 0;
+        size_t length = 0;
+        for (size_t i = 1; i <= capacity; ++i) {
+            if (isTaken((start + i) % capacity)) {
+                maxLength = std::max(maxLength, ++length);
+            }
+            else {
+                length = 0;
+            }
+        }
+        return maxLength;
+    }
+
+    /// Probe lengths and resizes recorded since construction or the last reset.
+    /// Empty unless HASH_MAP_STATISTICS is enabled
+    using HashMapStatisticsHolder::GetStatistics;
+    using HashMapStatisticsHolder::ResetStatistics;
+
+    /// Makes space for 'count' elements without exceeding the maximum load factor
+    void Reserve(size_t count) {
+        const size_t capacity = CapacityFor(count);
+        if (capacity > m_table.GetCapacity()) {
+            Rehash(capacity);
+        }
+    }
+
+    /// Rehashes to the smallest table which keeps current elements under the maximum load factor
+    void ShrinkToFit() {
+        const size_t capacity = CapacityFor(m_size);
+        if (capacity < m_table.GetCapacity()) {
+            Rehash(capacity);
+        }
+    }
+
+    /// Value in (0, 1]. Table grows when the next element would exceed it.
+    /// Values above CollisionPolicy::MaxLoadFactor are lowered to it
+    void SetMaxLoadFactor(float maxLoadFactor) {
+        assert(maxLoadFactor > 0.f && maxLoadFactor <= 1.f);
+        m_maxLoadFactor = std::min(maxLoadFactor, CollisionPolicy::MaxLoadFactor);
+        Reserve(m_size);
+    }
+
+    float GetMaxLoadFactor() const {
+        return m_maxLoadFactor;
+    }
+
+    float GetLoadFactor() const {
+        return static_cast<float>(m_size) / static_cast<float>(m_table.GetCapacity());
+    }
+
+    size_t GetSize() const {
+        return m_size;
+    }
+
+    size_t GetTombstonesCount() const {
+        return m_tombstones;
     }
 
     size_t GetCapacity() const
     {
-        return m_table.size();
+        return m_table.GetCapacity();
     }
 
 private:
-    Hash GetHash(const Key& key) {
-        const Hash hash{ m_hasher(key, m_hashSize) };
+    // Hasher gives full width hash, the map reduces it to table size itself.
+    // Multiplicative mix spreads all bits of the hash over the low ones taken by modulo
+    Hash GetHash(const Key& key) const {
+        const uint64_t mixed = static_cast<uint64_t>(m_hasher(key)) * 0x9E3779B97F4A7C15ull;
+        const Hash hash{ static_cast<size_t>(mixed ^ (mixed >> 32)) };
         return hash;
     }
 
-    TableElement* FindElement(const Key& key) {
-        const Hash hash = GetHash(key);
-        for (size_t collisionIndex = 0; collisionIndex < m_table.size(); ++collisionIndex) {
+    // Returns slot index or NoIndex. Probes are recorded for 'operation', lookups of missing keys as FindMissing
+    size_t FindIndex(const Key& key, const Hash& hash, HashMapOperation operation = HashMapOperation::Find) const {
+        auto found = [&](size_t index, size_t probes) {
+            const bool missing = index == NoIndex && operation == HashMapOperation::Find;
+            GetStatisticsRecorder().RecordProbes(missing ? HashMapOperation::FindMissing : operation, probes);
+            return index;
+        };
+
+        if constexpr (CollisionPolicy::RobinHood) {
+            // Elements of the probe path farther from home than this key could be are not visited
+            size_t index = HashToTableIndex(0, hash);
+            for (uint32_t distance = 0; ; ++distance) {
+                const KeySlot& keySlot = m_table.GetKeySlot(index);
+                if (!keySlot.has_value || keySlot.distance < distance) {
+                    return found(NoIndex, size_t{ distance } + 1);
+                }
+
+                if (keySlot.key == key) {
+                    return found(index, size_t{ distance } + 1);
+                }
+
+                index = NextIndex(index);
+            }
+        }
+
+        size_t collisionIndex = 0;
+        for (; collisionIndex < m_table.GetCapacity(); ++collisionIndex) {
+            const size_t tableIndex = HashToTableIndex(collisionIndex, hash);
+            const KeySlot& keySlot = m_table.GetKeySlot(tableIndex);
+            if (!keySlot.has_value) {
+                if (keySlot.deleted) {
+                    continue;
+                }
+                return found(NoIndex, collisionIndex + 1);
+            }
+
+            if (keySlot.key == key) {
+                return found(tableIndex, collisionIndex + 1);
+            }
+        }
+
+        return found(NoIndex, collisionIndex);
+    }
+
+    // First empty slot or tombstone of the probe sequence, NoIndex if there is none.
+    // 'key' (if given) is checked not to be on the probe path before it in debug builds
+    size_t FindFreeIndex(const Hash& hash, uint32_t& distance, [[maybe_unused]] const Key* key = nullptr) const {
+        for (size_t collisionIndex = 0; collisionIndex < m_table.GetCapacity(); ++collisionIndex) {
             const size_t tableIndex = HashToTableIndex(collisionIndex, hash);
-            auto& tableElement = m_table[tableIndex];
-            if (!tableElement.has_value) {
-                break;
+            const KeySlot& keySlot = m_table.GetKeySlot(tableIndex);
+            if (!keySlot.has_value) {
+                distance = static_cast<uint32_t>(collisionIndex);
+                return tableIndex;
+            }
+
+            assert(key == nullptr || keySlot.key != *key);
+        }
+
+        return NoIndex;
+    }
+
+    // Robin Hood insertion: the element carried along the probe path is swapped with
+    // any element that is closer to its home slot. Returns slot of the inserted element,
+    // 'probes' is set to the count of visited slots. Table always has a free slot (load factor never exceeds 1)
+    size_t InsertRobinHood(TableElement element, const Hash& hash, size_t& probes) {
+        size_t inserted = NoIndex;
+        size_t index = HashToTableIndex(0, hash);
+        element.keySlot.distance = 0;
+        for (probes = 1; ; ++probes) {
+            KeySlot& keySlot = m_table.GetKeySlot(index);
+            if (!keySlot.has_value) {
+                keySlot = std::move(element.keySlot);
+                m_table.GetValue(index) = std::move(element.value);
+                return inserted != NoIndex ? inserted : index;
             }
 
-            if (tableElement.key == key) {
-                return &tableElement;
+            assert(inserted != NoIndex || keySlot.key != element.keySlot.key);
+            if (keySlot.distance < element.keySlot.distance) {
+                std::swap(keySlot, element.keySlot);
+                std::swap(m_table.GetValue(index), element.value);
+                if (inserted == NoIndex) {
+                    inserted = index;
+                }
             }
+
+            ++element.keySlot.distance;
+            index = NextIndex(index);
         }
+    }
+
+    // Next element of a Robin Hood cluster can move one slot back
+    bool IsShiftable(size_t index) const {
+        const KeySlot& keySlot = m_table.GetKeySlot(index);
+        return keySlot.has_value && keySlot.distance != 0;
+    }
+
+    void MoveElement(size_t to, size_t from) {
+        m_table.GetKeySlot(to) = std::move(m_table.GetKeySlot(from));
+        m_table.GetValue(to) = std::move(m_table.GetValue(from));
+    }
 
-        return nullptr;
+    void SwapElements(size_t first, size_t second) {
+        std::swap(m_table.GetKeySlot(first), m_table.GetKeySlot(second));
+        std::swap(m_table.GetValue(first), m_table.GetValue(second));
     }
 
-    size_t HashToTableIndex(size_t collisionIndex, const Hash& hash) {
-        const size_t index = m_collisionPolicy(collisionIndex, hash.value) % m_table.size();
+    size_t NextIndex(size_t index) const {
+        return index + 1 == m_table.GetCapacity() ? 0 : index + 1;
+    }
+
+    size_t HashToTableIndex(size_t collisionIndex, const Hash& hash) const {
+        const size_t index = m_collisionPolicy(collisionIndex, hash.value) % m_table.GetCapacity();
         return index;
     }
 
-    size_t ComputeCapacity(size_t bytesCount) {
+    size_t ComputeCapacity(size_t bytesCount) const {
         size_t capacity = 1;
         for (size_t i = 0; i < bytesCount; ++i) {
             capacity *= 256;
@@ -139,17 +567,121 @@ private:
         return capacity;
     }
 
-    void UpdateCapacity() {
-        const size_t capacity = ComputeCapacity(m_hashSize);
-        TableElement defaultElement;
-        defaultElement.has_value = false;
-        m_table.resize(capacity, defaultElement);
+    // Capacities are powers of two adjusted by collision policy
+    size_t GrowCapacity(size_t capacity) const {
+        size_t powerOfTwo = MinCapacity;
+        while (m_collisionPolicy.AdjustCapacity(powerOfTwo) <= capacity) {
+            powerOfTwo *= 2;
+        }
+        return m_collisionPolicy.AdjustCapacity(powerOfTwo);
+    }
+
+    size_t CapacityFor(size_t count) const {
+        size_t powerOfTwo = MinCapacity;
+        while (m_maxLoadFactor * static_cast<float>(m_collisionPolicy.AdjustCapacity(powerOfTwo)) < static_cast<float>(count)) {
+            powerOfTwo *= 2;
+        }
+        return m_collisionPolicy.AdjustCapacity(powerOfTwo);
+    }
+
+    void MakeTombstone(size_t index) {
+        KeySlot& keySlot = m_table.GetKeySlot(index);
+        keySlot.has_value = false;
+        keySlot.deleted = true;
+        if constexpr (!std::is_trivially_destructible_v<Key> || !std::is_trivially_destructible_v<Value>) {
+            keySlot.key = Key{};
+            m_table.GetValue(index) = Value{};
+        }
+        --m_size;
+        ++m_tombstones;
+    }
+
+    // Drops tombstones without reallocation. Elements are marked (has_value and deleted) as not placed,
+    // then each one moves to the first slot of its probe sequence which is empty or not placed,
+    // swapping with the element there in the latter case. Slots of placed elements never become free again,
+    // so every placed element is reachable by lookup through occupied slots
+    void RehashInPlace() {
+        GetStatisticsRecorder().RecordResize(ResizeEvent{ m_size, m_table.GetCapacity(), m_table.GetCapacity(), true });
+        for (size_t index = 0; index < m_table.GetCapacity(); ++index) {
+            KeySlot& keySlot = m_table.GetKeySlot(index);
+            keySlot.deleted = keySlot.has_value;
+        }
+
+        for (size_t index = 0; index < m_table.GetCapacity(); ++index) {
+            while (m_table.GetKeySlot(index).has_value && m_table.GetKeySlot(index).deleted) {
+                const Hash hash = GetHash(m_table.GetKeySlot(index).key);
+                // Element was found on its probe sequence, so the search stops at 'index' at the latest
+                size_t collisionIndex = 0;
+                size_t targetIndex = HashToTableIndex(collisionIndex, hash);
+                while (m_table.GetKeySlot(targetIndex).has_value && !m_table.GetKeySlot(targetIndex).deleted) {
+                    targetIndex = HashToTableIndex(++collisionIndex, hash);
+                }
+
+                if (targetIndex != index) {
+                    if (m_table.GetKeySlot(targetIndex).has_value) {
+                        SwapElements(index, targetIndex);
+                    }
+                    else {
+                        MoveElement(targetIndex, index);
+                        KeySlot& keySlot = m_table.GetKeySlot(index);
+                        keySlot.has_value = false;
+                        keySlot.deleted = false;
+                    }
+                }
+
+                KeySlot& target = m_table.GetKeySlot(targetIndex);
+                target.deleted = false;
+                target.distance = static_cast<uint32_t>(collisionIndex);
+            }
+        }
+        m_tombstones = 0;
+    }
+
+    // Moves all elements to a new table of given capacity at once
+    void Rehash(size_t capacity) {
+        if (m_table.GetCapacity() != 0) {
+            GetStatisticsRecorder().RecordResize(ResizeEvent{ m_size, m_table.GetCapacity(), capacity, false });
+        }
+
+        Table table(capacity, KeySlot{ Key{}, false, false, 0 });
+        std::swap(table, m_table);
+        m_tombstones = 0;
+
+        for (size_t index = 0; index < table.GetCapacity(); ++index) {
+            KeySlot& keySlot = table.GetKeySlot(index);
+            if (!keySlot.has_value) {
+                continue;
+            }
+
+            const Hash hash = GetHash(keySlot.key);
+            TableElement element{ std::move(keySlot), std::move(table.GetValue(index)) };
+            if constexpr (CollisionPolicy::RobinHood) {
+                size_t probes = 0;
+                InsertRobinHood(std::move(element), hash, probes);
+            }
+            else {
+                uint32_t distance = 0;
+                size_t destination = FindFreeIndex(hash, distance);
+                while (destination == NoIndex) {
+                    // Probe sequence may not visit every slot (quadratic probing): elements placed so far
+                    // move to a larger table, the rest go there too
+                    Rehash(GrowCapacity(m_table.GetCapacity()));
+                    destination = FindFreeIndex(hash, distance);
+                }
+                element.keySlot.distance = distance;
+                m_table.GetKeySlot(destination) = std::move(element.keySlot);
+                m_table.GetValue(destination) = std::move(element.value);
+            }
+        }
     }
 
 private:
+    static constexpr size_t MinCapacity = 8;
+
     Hasher m_hasher;
     CollisionPolicy m_collisionPolicy;
-    size_t m_hashSize = 2;
+    float m_maxLoadFactor = std::min(DefaultMaxLoadFactor, CollisionPolicy::MaxLoadFactor);
     size_t m_size = 0;
-    std::vector<TableElement> m_table;
-};
\ No newline at end of file
+    size_t m_tombstones = 0;
+    Table m_table;
+};
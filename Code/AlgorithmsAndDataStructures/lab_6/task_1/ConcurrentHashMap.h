@@ -0,0 +1,219 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Hash map for concurrent access: keys are spread over lock-striped shards, each shard is
+// a linear probing table. Writers of a shard are serialized by its mutex, readers take no lock:
+// they read optimistically and retry if the shard's sequence counter (seqlock) changed meanwhile.
+// Slots are atomics accessed with relaxed order, so racing reads are defined behavior,
+// which restricts keys and values to trivially copyable types.
+// Grown tables are retired, not freed, until the map is destroyed: a reader may still walk them.
+template
+<
+    typename Key,
+    typename Value,
+    typename Hasher,
+    size_t ShardsCount = 64
+>
+class ConcurrentHashMap
+{
+    static_assert(std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Value>);
+    static_assert((ShardsCount & (ShardsCount - 1)) == 0, "Shards count must be a power of two");
+
+private:
+    struct Slot
+    {
+        std::atomic<bool> occupied{ false };
+        std::atomic<Key> key{};
+        std::atomic<Value> value{};
+    };
+
+    struct Table
+    {
+        explicit Table(size_t capacity) :
+            capacity(capacity),
+            slots(new Slot[capacity])
+        {}
+
+        const size_t capacity;
+        const std::unique_ptr<Slot[]> slots;
+    };
+
+    // Own cache line per shard: writers of different shards don't invalidate each other
+    struct alignas(64) Shard
+    {
+        mutable std::mutex writeMutex;
+        // Odd while a writer modifies the shard
+        std::atomic<uint64_t> sequence{ 0 };
+        std::atomic<Table*> table{ nullptr };
+        size_t size = 0;
+        std::vector<std::unique_ptr<Table>> tables;
+    };
+
+    static constexpr size_t MinShardCapacity = 16;
+    // Linear probing stays short at this load
+    static constexpr size_t MaxLoadPercent = 50;
+
+public:
+    /// Reserves space for about 'expectedSize' elements in total
+    ConcurrentHashMap(size_t expectedSize = 0) {
+        size_t capacity = MinShardCapacity;
+        while (capacity * MaxLoadPercent / 100 < expectedSize / ShardsCount + 1) {
+            capacity *= 2;
+        }
+
+        for (Shard& shard : m_shards) {
+            shard.tables.push_back(std::make_unique<Table>(capacity));
+            shard.table.store(shard.tables.back().get(), std::memory_order_relaxed);
+        }
+    }
+
+    /// Returns false if key is already in map
+    bool Insert(const Key& key, const Value& value) {
+        return Write(key, value, false);
+    }
+
+    /// Inserts the key or replaces its value. Returns false if key was already in map
+    bool InsertOrAssign(const Key& key, const Value& value) {
+        return Write(key, value, true);
+    }
+
+    /// Lock free unless a writer of the same shard is active
+    std::optional<Value> Find(const Key& key) const {
+        const size_t hash = GetHash(key);
+        const Shard& shard = m_shards[ShardIndex(hash)];
+        while (true) {
+            const uint64_t sequence = shard.sequence.load(std::memory_order_acquire);
+            if (sequence & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            const Table* table = shard.table.load(std::memory_order_acquire);
+            std::optional<Value> result;
+            const size_t mask = table->capacity - 1;
+            for (size_t i = 0, index = hash & mask; i < table->capacity; ++i, index = (index + 1) & mask) {
+                const Slot& slot = table->slots[index];
+                if (!slot.occupied.load(std::memory_order_relaxed)) {
+                    break;
+                }
+
+                if (slot.key.load(std::memory_order_relaxed) == key) {
+                    result = slot.value.load(std::memory_order_relaxed);
+                    break;
+                }
+            }
+
+            // Reads above must complete before the sequence is checked again
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (shard.sequence.load(std::memory_order_relaxed) == sequence) {
+                return result;
+            }
+        }
+    }
+
+    /// Sum over shards, exact when no writer is active
+    size_t GetSize() const {
+        size_t size = 0;
+        for (const Shard& shard : m_shards) {
+            std::lock_guard<std::mutex> guard(shard.writeMutex);
+            size += shard.size;
+        }
+        return size;
+    }
+
+private:
+    // Shard is chosen by the high bits of the hash, slot by the low ones
+    static size_t ShardIndex(size_t hash) {
+        return static_cast<size_t>(static_cast<uint64_t>(hash) >> 58) & (ShardsCount - 1);
+    }
+
+    size_t GetHash(const Key& key) const {
+        const uint64_t mixed = static_cast<uint64_t>(m_hasher(key)) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(mixed ^ (mixed >> 29));
+    }
+
+    bool Write(const Key& key, const Value& value, bool assign) {
+        const size_t hash = GetHash(key);
+        Shard& shard = m_shards[ShardIndex(hash)];
+        std::lock_guard<std::mutex> guard(shard.writeMutex);
+
+        Table* table = shard.table.load(std::memory_order_relaxed);
+        Slot* slot = FindSlot(*table, key, hash);
+        if (slot->occupied.load(std::memory_order_relaxed)) {
+            if (assign) {
+                BeginWrite(shard);
+                slot->value.store(value, std::memory_order_relaxed);
+                EndWrite(shard);
+            }
+            return false;
+        }
+
+        if ((shard.size + 1) * 100 > table->capacity * MaxLoadPercent) {
+            table = Grow(shard);
+            slot = FindSlot(*table, key, hash);
+        }
+
+        BeginWrite(shard);
+        slot->key.store(key, std::memory_order_relaxed);
+        slot->value.store(value, std::memory_order_relaxed);
+        slot->occupied.store(true, std::memory_order_relaxed);
+        EndWrite(shard);
+        ++shard.size;
+        return true;
+    }
+
+    // Slot holding the key or the free slot where it belongs. Table always has free slots
+    static Slot* FindSlot(Table& table, const Key& key, size_t hash) {
+        const size_t mask = table.capacity - 1;
+        for (size_t index = hash & mask; ; index = (index + 1) & mask) {
+            Slot& slot = table.slots[index];
+            if (!slot.occupied.load(std::memory_order_relaxed) || slot.key.load(std::memory_order_relaxed) == key) {
+                return &slot;
+            }
+        }
+    }
+
+    // Copies the shard into a table twice as large and publishes it.
+    // The old table is not modified, so readers walking it still see a consistent shard
+    Table* Grow(Shard& shard) {
+        const Table& old = *shard.table.load(std::memory_order_relaxed);
+        auto table = std::make_unique<Table>(old.capacity * 2);
+        for (size_t i = 0; i < old.capacity; ++i) {
+            const Slot& slot = old.slots[i];
+            if (slot.occupied.load(std::memory_order_relaxed)) {
+                const Key key = slot.key.load(std::memory_order_relaxed);
+                Slot* destination = FindSlot(*table, key, GetHash(key));
+                destination->key.store(key, std::memory_order_relaxed);
+                destination->value.store(slot.value.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                destination->occupied.store(true, std::memory_order_relaxed);
+            }
+        }
+
+        shard.table.store(table.get(), std::memory_order_release);
+        shard.tables.push_back(std::move(table));
+        return shard.tables.back().get();
+    }
+
+    static void BeginWrite(Shard& shard) {
+        shard.sequence.store(shard.sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        // Slot stores must not become visible before the odd sequence
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    static void EndWrite(Shard& shard) {
+        shard.sequence.store(shard.sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+private:
+    Hasher m_hasher;
+    Shard m_shards[ShardsCount];
+};
@@ -0,0 +1,287 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Bucketized cuckoo hashing: every key lives in one of two buckets chosen by two hashes.
+// A bucket keeps 4 keys with the occupancy mask in one cache line (for keys up to 15 bytes),
+// values are stored separately, so a lookup scans at most two key lines and reads one value line
+// on a hit (plus a tiny stash while it is not empty).
+// Insertion into two full buckets searches breadth first for the shortest chain of moves
+// to a free slot, elements which can't be placed go to the stash, a full stash doubles the table.
+// Stash never exceeds MaxStashSize: a hasher with too few distinct values for the keys makes Emplace throw
+template
+<
+    typename Key,
+    typename Value,
+    typename Hasher
+>
+class CuckooHashMap
+{
+public:
+    static constexpr size_t SlotsPerBucket = 4;
+
+private:
+    static constexpr size_t CacheLineSize = 64;
+
+    struct alignas(CacheLineSize) Bucket
+    {
+        Key keys[SlotsPerBucket];
+        uint8_t occupied = 0;
+
+        bool IsOccupied(size_t slot) const {
+            return (occupied & (1u << slot)) != 0;
+        }
+
+        // Returns SlotsPerBucket if bucket is full
+        size_t FreeSlot() const {
+            for (size_t slot = 0; slot < SlotsPerBucket; ++slot) {
+                if (!IsOccupied(slot)) {
+                    return slot;
+                }
+            }
+            return SlotsPerBucket;
+        }
+    };
+
+    struct Hash
+    {
+        size_t first;
+        size_t second;
+    };
+
+    // Node of insertion path search: element in 'slot' of the parent bucket may move to 'bucket'
+    struct PathNode
+    {
+        size_t bucket;
+        size_t parent;
+        size_t slot;
+    };
+
+    static constexpr size_t NoParent = std::numeric_limits<size_t>::max();
+    // Bounds the breadth first search: about 4 levels of displacements
+    static constexpr size_t MaxPathNodes = 256;
+    static constexpr size_t MaxStashSize = 4;
+    static constexpr size_t MaxCapacityPerElement = 16;
+
+public:
+    /// Initial capacity is 256^hashSize slots
+    CuckooHashMap(size_t hashSize) {
+        size_t capacity = 1;
+        for (size_t i = 0; i < hashSize; ++i) {
+            capacity *= 256;
+        }
+        m_buckets.resize(capacity < SlotsPerBucket ? 1 : capacity / SlotsPerBucket);
+        m_values.resize(GetCapacity());
+        m_stash.reserve(MaxStashSize);
+    }
+
+    /// The key must not be in the map.
+    /// Returned pointer is valid until the next insertion: displacements move values.
+    /// Throws std::runtime_error if the element can't be placed even in a table
+    /// MaxCapacityPerElement times larger than the map (hasher gives too few distinct values)
+    template<typename... Args>
+    Value* Emplace(Key key, Args&&... args) {
+        assert(Find(key) == nullptr);
+        Value* value = Insert(std::move(key), Value(std::forward<Args>(args)...));
+        ++m_size;
+        return value;
+    }
+
+    Value* Find(const Key& key) {
+        const Hash hash = GetHash(key);
+        for (size_t bucketIndex : { hash.first, hash.second }) {
+            Bucket& bucket = m_buckets[bucketIndex];
+            for (size_t slot = 0; slot < SlotsPerBucket; ++slot) {
+                if (bucket.IsOccupied(slot) && bucket.keys[slot] == key) {
+                    return &m_values[bucketIndex * SlotsPerBucket + slot];
+                }
+            }
+        }
+
+        for (auto& [stashedKey, value] : m_stash) {
+            if (stashedKey == key) {
+                return &value;
+            }
+        }
+
+        return nullptr;
+    }
+
+    /// Returns false if key is not in map
+    bool Erase(const Key& key) {
+        const Hash hash = GetHash(key);
+        for (size_t bucketIndex : { hash.first, hash.second }) {
+            Bucket& bucket = m_buckets[bucketIndex];
+            for (size_t slot = 0; slot < SlotsPerBucket; ++slot) {
+                if (bucket.IsOccupied(slot) && bucket.keys[slot] == key) {
+                    bucket.occupied &= static_cast<uint8_t>(~(1u << slot));
+                    --m_size;
+                    return true;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < m_stash.size(); ++i) {
+            if (m_stash[i].first == key) {
+                m_stash[i] = std::move(m_stash.back());
+                m_stash.pop_back();
+                --m_size;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    size_t GetSize() const {
+        return m_size;
+    }
+
+    size_t GetStashSize() const {
+        return m_stash.size();
+    }
+
+    size_t GetCapacity() const
+    {
+        return m_buckets.size() * SlotsPerBucket;
+    }
+
+private:
+    // Two bucket indices from one full width hash by two multiplicative mixes
+    Hash GetHash(const Key& key) const {
+        const uint64_t hash = static_cast<uint64_t>(m_hasher(key));
+        const uint64_t a = hash * 0x9E3779B97F4A7C15ull;
+        const uint64_t b = hash * 0xC2B2AE3D27D4EB4Full;
+        const size_t mask = m_buckets.size() - 1;
+        const size_t first = static_cast<size_t>(a ^ (a >> 32)) & mask;
+        size_t second = static_cast<size_t>(b ^ (b >> 32)) & mask;
+        if (second == first) {
+            second = (first + 1) & mask;
+        }
+        return Hash{ first, second };
+    }
+
+    size_t AlternateBucket(const Key& key, size_t bucket) const {
+        const Hash hash = GetHash(key);
+        return bucket == hash.first ? hash.second : hash.first;
+    }
+
+    Value* Insert(Key key, Value value) {
+        while (true) {
+            const Hash hash = GetHash(key);
+            for (size_t bucketIndex : { hash.first, hash.second }) {
+                const size_t slot = m_buckets[bucketIndex].FreeSlot();
+                if (slot != SlotsPerBucket) {
+                    return Place(bucketIndex, slot, std::move(key), std::move(value));
+                }
+            }
+
+            const size_t pathEnd = FindPath(hash);
+            if (pathEnd != NoParent && MoveAlongPath(pathEnd)) {
+                continue;
+            }
+
+            if (m_stash.size() < MaxStashSize) {
+                m_stash.emplace_back(std::move(key), std::move(value));
+                return &m_stash.back().second;
+            }
+
+            // Table many times larger than its contents can't help: hash has too few distinct values
+            if (GetCapacity() > MaxCapacityPerElement * m_size) {
+                throw std::runtime_error("Cuckoo hash map can't place element: hasher gives too few distinct values");
+            }
+
+            Rehash(m_buckets.size() * 2);
+        }
+    }
+
+    Value* Place(size_t bucketIndex, size_t slot, Key key, Value value) {
+        Bucket& bucket = m_buckets[bucketIndex];
+        bucket.keys[slot] = std::move(key);
+        bucket.occupied |= static_cast<uint8_t>(1u << slot);
+        Value& placed = m_values[bucketIndex * SlotsPerBucket + slot];
+        placed = std::move(value);
+        return &placed;
+    }
+
+    // Breadth first search from both buckets of the key to the nearest bucket with a free slot.
+    // Returns index of its node in m_path or NoParent
+    size_t FindPath(const Hash& hash) {
+        m_path.clear();
+        m_path.push_back(PathNode{ hash.first, NoParent, 0 });
+        m_path.push_back(PathNode{ hash.second, NoParent, 0 });
+        for (size_t head = 0; head < m_path.size(); ++head) {
+            const size_t bucketIndex = m_path[head].bucket;
+            const Bucket& bucket = m_buckets[bucketIndex];
+            if (bucket.FreeSlot() != SlotsPerBucket) {
+                return head;
+            }
+
+            if (m_path.size() + SlotsPerBucket <= MaxPathNodes) {
+                for (size_t slot = 0; slot < SlotsPerBucket; ++slot) {
+                    m_path.push_back(PathNode{ AlternateBucket(bucket.keys[slot], bucketIndex), head, slot });
+                }
+            }
+        }
+
+        return NoParent;
+    }
+
+    // Moves elements from the free end of the path towards its start, which frees a slot there.
+    // Path may visit a bucket twice; a step whose element has changed is not made
+    bool MoveAlongPath(size_t node) {
+        while (m_path[node].parent != NoParent) {
+            const PathNode& child = m_path[node];
+            const PathNode& parent = m_path[child.parent];
+            Bucket& from = m_buckets[parent.bucket];
+            if (!from.IsOccupied(child.slot) || AlternateBucket(from.keys[child.slot], parent.bucket) != child.bucket) {
+                return false;
+            }
+
+            const size_t slot = m_buckets[child.bucket].FreeSlot();
+            assert(slot != SlotsPerBucket);
+            Place(child.bucket, slot, std::move(from.keys[child.slot]), std::move(m_values[parent.bucket * SlotsPerBucket + child.slot]));
+            from.occupied &= static_cast<uint8_t>(~(1u << child.slot));
+            node = child.parent;
+        }
+        return true;
+    }
+
+    // Reinserts all elements into a table of 'bucketsCount' buckets
+    void Rehash(size_t bucketsCount) {
+        std::vector<Bucket> buckets(bucketsCount);
+        std::swap(buckets, m_buckets);
+        std::vector<Value> values(GetCapacity());
+        std::swap(values, m_values);
+        std::vector<std::pair<Key, Value>> stash;
+        stash.reserve(MaxStashSize);
+        std::swap(stash, m_stash);
+
+        for (size_t bucketIndex = 0; bucketIndex < buckets.size(); ++bucketIndex) {
+            Bucket& bucket = buckets[bucketIndex];
+            for (size_t slot = 0; slot < SlotsPerBucket; ++slot) {
+                if (bucket.IsOccupied(slot)) {
+                    Insert(std::move(bucket.keys[slot]), std::move(values[bucketIndex * SlotsPerBucket + slot]));
+                }
+            }
+        }
+
+        for (auto& [key, value] : stash) {
+            Insert(std::move(key), std::move(value));
+        }
+    }
+
+private:
+    Hasher m_hasher;
+    size_t m_size = 0;
+    std::vector<Bucket> m_buckets;
+    // Value of slot 'slot' of bucket 'bucket' is at bucket * SlotsPerBucket + slot
+    std::vector<Value> m_values;
+    std::vector<std::pair<Key, Value>> m_stash;
+    std::vector<PathNode> m_path;
+};
@@ -0,0 +1,287 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FLAT_HASH_MAP_SSE2 1
+#include <emmintrin.h>
+#else
+#define FLAT_HASH_MAP_SSE2 0
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Control byte of a slot: empty and deleted states have the sign bit set,
+// full slots keep 7 bits of hash (fingerprint) so most mismatches are rejected without touching keys
+enum class ControlByte : int8_t
+{
+    Empty = -128,
+    Deleted = -2
+};
+
+// Bit per slot of a group, iterated from the lowest one
+class GroupMask
+{
+public:
+    explicit GroupMask(uint32_t mask) :
+        m_mask(mask)
+    {}
+
+    explicit operator bool() const {
+        return m_mask != 0;
+    }
+
+    size_t LowestSlot() const {
+        assert(m_mask != 0);
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, m_mask);
+        return index;
+#else
+        return static_cast<size_t>(__builtin_ctz(m_mask));
+#endif
+    }
+
+    void RemoveLowest() {
+        m_mask &= m_mask - 1;
+    }
+
+private:
+    uint32_t m_mask;
+};
+
+// 16 control bytes compared at once: one SSE2 compare instead of 16 branches
+class ControlGroup
+{
+public:
+    static constexpr size_t Width = 16;
+
+    explicit ControlGroup(const int8_t* control) {
+#if FLAT_HASH_MAP_SSE2
+        m_control = _mm_loadu_si128(reinterpret_cast<const __m128i*>(control));
+#else
+        for (size_t i = 0; i < Width; ++i) {
+            m_control[i] = control[i];
+        }
+#endif
+    }
+
+    GroupMask Match(int8_t fingerprint) const {
+#if FLAT_HASH_MAP_SSE2
+        const __m128i equal = _mm_cmpeq_epi8(_mm_set1_epi8(fingerprint), m_control);
+        return GroupMask(static_cast<uint32_t>(_mm_movemask_epi8(equal)));
+#else
+        return MatchIf([fingerprint](int8_t c) { return c == fingerprint; });
+#endif
+    }
+
+    GroupMask MatchEmpty() const {
+        return Match(static_cast<int8_t>(ControlByte::Empty));
+    }
+
+    GroupMask MatchEmptyOrDeleted() const {
+#if FLAT_HASH_MAP_SSE2
+        // Sign bits of control bytes
+        return GroupMask(static_cast<uint32_t>(_mm_movemask_epi8(m_control)));
+#else
+        return MatchIf([](int8_t c) { return c < 0; });
+#endif
+    }
+
+private:
+#if FLAT_HASH_MAP_SSE2
+    __m128i m_control;
+#else
+    template<typename Condition>
+    GroupMask MatchIf(Condition condition) const {
+        uint32_t mask = 0;
+        for (size_t i = 0; i < Width; ++i) {
+            if (condition(m_control[i])) {
+                mask |= uint32_t{ 1 } << i;
+            }
+        }
+        return GroupMask(mask);
+    }
+
+    int8_t m_control[Width];
+#endif
+};
+
+// Open addressing map in Swiss table layout: control bytes are kept apart from slots
+// and probed by groups of 16. Capacity is a power of two, so groups are chosen by mask.
+// Probing visits groups by triangular numbers which covers every group of power of two count.
+// Erased slots become tombstones unless their group has an empty slot
+// (then no probe sequence continues past the group).
+template
+<
+    typename Key,
+    typename Value,
+    typename Hasher
+>
+class FlatHashMap
+{
+private:
+    struct Hash
+    {
+        // Slot index hash
+        size_t value;
+        // Fingerprint stored in control byte
+        int8_t fingerprint;
+    };
+
+    struct Slot
+    {
+        Key key;
+        Value value;
+    };
+
+public:
+    FlatHashMap(size_t hashSize) :
+        m_hashSize(hashSize)
+    {
+        UpdateCapacity();
+    }
+
+    /// Returns nullptr if key is already in map or there is no free slot
+    template<typename... Args>
+    Value* Emplace(Key key, Args&&... args) {
+        const Hash hash = GetHash(key);
+        size_t freeSlot = m_slots.size();
+        for (size_t probe = 0, group = FirstGroup(hash); probe < GetGroupsCount(); group = NextGroup(group, ++probe)) {
+            const size_t groupBegin = group * ControlGroup::Width;
+            const ControlGroup controlGroup(&m_control[groupBegin]);
+            for (GroupMask match = controlGroup.Match(hash.fingerprint); match; match.RemoveLowest()) {
+                if (m_slots[groupBegin + match.LowestSlot()].key == key) {
+                    return nullptr;
+                }
+            }
+
+            if (freeSlot == m_slots.size()) {
+                const GroupMask free = controlGroup.MatchEmptyOrDeleted();
+                if (free) {
+                    freeSlot = groupBegin + free.LowestSlot();
+                }
+            }
+
+            // Key would have been placed here or earlier
+            if (controlGroup.MatchEmpty()) {
+                break;
+            }
+        }
+
+        if (freeSlot == m_slots.size()) {
+            return nullptr;
+        }
+
+        m_control[freeSlot] = hash.fingerprint;
+        Slot& slot = m_slots[freeSlot];
+        slot.key = key;
+        slot.value = Value(std::forward<Args>(args)...);
+        ++m_size;
+        return &slot.value;
+    }
+
+    Value* Find(const Key& key) {
+        const size_t index = FindSlot(key);
+        return index != m_slots.size() ? &m_slots[index].value : nullptr;
+    }
+
+    /// Returns false if key is not in map
+    bool Erase(const Key& key) {
+        const size_t index = FindSlot(key);
+        if (index == m_slots.size()) {
+            return false;
+        }
+
+        const size_t groupBegin = index - index % ControlGroup::Width;
+        const bool probesStopHere = static_cast<bool>(ControlGroup(&m_control[groupBegin]).MatchEmpty());
+        m_control[index] = static_cast<int8_t>(probesStopHere ? ControlByte::Empty : ControlByte::Deleted);
+        if constexpr (!std::is_trivially_destructible_v<Key> || !std::is_trivially_destructible_v<Value>) {
+            m_slots[index] = Slot{};
+        }
+        --m_size;
+        return true;
+    }
+
+    size_t GetSize() const {
+        return m_size;
+    }
+
+    size_t GetCapacity() const
+    {
+        return m_slots.size();
+    }
+
+private:
+    // Hasher output selects the slot as in ClosedHashMap.
+    // Fingerprint is taken from the top bits of its multiplicative mix,
+    // so it does not repeat bits that already selected the group
+    Hash GetHash(const Key& key) const {
+        const size_t value = m_hasher(key, m_hashSize);
+        const uint64_t mixed = static_cast<uint64_t>(value) * 0x9E3779B97F4A7C15ull;
+        return Hash{ value, static_cast<int8_t>(mixed >> 57) };
+    }
+
+    size_t GetGroupsCount() const {
+        return m_slots.size() / ControlGroup::Width;
+    }
+
+    size_t FirstGroup(const Hash& hash) const {
+        return (hash.value / ControlGroup::Width) & (GetGroupsCount() - 1);
+    }
+
+    // Offsets 1, 3, 6, 10, ... from the first group
+    size_t NextGroup(size_t group, size_t probe) const {
+        return (group + probe) & (GetGroupsCount() - 1);
+    }
+
+    // Returns slot index or capacity if key is not found
+    size_t FindSlot(const Key& key) const {
+        const Hash hash = GetHash(key);
+        for (size_t probe = 0, group = FirstGroup(hash); probe < GetGroupsCount(); group = NextGroup(group, ++probe)) {
+            const size_t groupBegin = group * ControlGroup::Width;
+            const ControlGroup controlGroup(&m_control[groupBegin]);
+            for (GroupMask match = controlGroup.Match(hash.fingerprint); match; match.RemoveLowest()) {
+                const size_t index = groupBegin + match.LowestSlot();
+                if (m_slots[index].key == key) {
+                    return index;
+                }
+            }
+
+            if (controlGroup.MatchEmpty()) {
+                break;
+            }
+        }
+
+        return m_slots.size();
+    }
+
+    static size_t ComputeCapacity(size_t bytesCount) {
+        size_t capacity = 1;
+        for (size_t i = 0; i < bytesCount; ++i) {
+            capacity *= 256;
+        }
+
+        // At least one whole group
+        return capacity < ControlGroup::Width ? ControlGroup::Width : capacity;
+    }
+
+    void UpdateCapacity() {
+        const size_t capacity = ComputeCapacity(m_hashSize);
+        m_control.assign(capacity, static_cast<int8_t>(ControlByte::Empty));
+        m_slots.resize(capacity);
+    }
+
+private:
+    Hasher m_hasher;
+    size_t m_hashSize = 2;
+    size_t m_size = 0;
+    std::vector<int8_t> m_control;
+    std::vector<Slot> m_slots;
+};
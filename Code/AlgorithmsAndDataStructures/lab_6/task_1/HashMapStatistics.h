@@ -0,0 +1,154 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+// Operation statistics of the hash maps are recorded only when HASH_MAP_STATISTICS is nonzero
+// (CMake option AADS_HASH_MAP_STATISTICS). Otherwise maps have an empty statistics base whose calls compile to nothing.
+// Recording lookups write to the map, so instrumented maps are not safe for concurrent lookups
+#ifndef HASH_MAP_STATISTICS
+#define HASH_MAP_STATISTICS 0
+#endif
+
+constexpr bool hashMapStatisticsEnabled = HASH_MAP_STATISTICS != 0;
+
+enum class HashMapOperation
+{
+    Emplace,
+    Find,
+    FindMissing,
+    Erase,
+    Count
+};
+
+/// Counts of lengths 0 ... MaxExactLength - 1, longer ones share the count of MaxExactLength
+class LengthHistogram
+{
+public:
+    static constexpr size_t MaxExactLength = 64;
+
+    void Add(size_t length) {
+        ++m_counts[std::min(length, MaxExactLength)];
+        ++m_count;
+        m_total += length;
+        m_maxLength = std::max(m_maxLength, length);
+    }
+
+    /// Count of 'length', or of all lengths from MaxExactLength on
+    uint64_t GetCount(size_t length) const {
+        return m_counts[std::min(length, MaxExactLength)];
+    }
+
+    uint64_t GetCount() const {
+        return m_count;
+    }
+
+    double GetMean() const {
+        return m_count != 0 ? static_cast<double>(m_total) / static_cast<double>(m_count) : 0.;
+    }
+
+    size_t GetMaxLength() const {
+        return m_maxLength;
+    }
+
+private:
+    std::array<uint64_t, MaxExactLength + 1> m_counts{};
+    uint64_t m_count = 0;
+    uint64_t m_total = 0;
+    size_t m_maxLength = 0;
+};
+
+struct ResizeEvent
+{
+    size_t size;
+    size_t oldCapacity;
+    size_t newCapacity;
+    // Tombstones dropped without reallocation
+    bool inPlace;
+};
+
+/// Probe lengths of each operation kind and the table resizes of one map
+class HashMapStatistics
+{
+public:
+    void RecordProbes(HashMapOperation operation, size_t probes) {
+        m_probes[static_cast<size_t>(operation)].Add(probes);
+    }
+
+    void RecordResize(const ResizeEvent& event) {
+        m_resizes.push_back(event);
+    }
+
+    const LengthHistogram& GetProbes(HashMapOperation operation) const {
+        return m_probes[static_cast<size_t>(operation)];
+    }
+
+    const std::vector<ResizeEvent>& GetResizes() const {
+        return m_resizes;
+    }
+
+    void Reset() {
+        *this = HashMapStatistics{};
+    }
+
+private:
+    std::array<LengthHistogram, static_cast<size_t>(HashMapOperation::Count)> m_probes;
+    std::vector<ResizeEvent> m_resizes;
+};
+
+// Recorder of maps built without statistics
+class DisabledHashMapStatistics
+{
+public:
+    void RecordProbes(HashMapOperation, size_t) {}
+
+    void RecordResize(const ResizeEvent&) {}
+
+    void Reset() {}
+};
+
+using HashMapStatisticsRecorder = std::conditional_t<hashMapStatisticsEnabled, HashMapStatistics, DisabledHashMapStatistics>;
+
+/// Private base of the maps which owns their statistics: lookups are const but record their probes.
+/// Without statistics the base is empty and doesn't add to the size of a map
+template<typename Recorder>
+class HashMapStatisticsHolder
+{
+public:
+    /// Empty unless HASH_MAP_STATISTICS is enabled
+    const Recorder& GetStatistics() const {
+        return m_statistics;
+    }
+
+    void ResetStatistics() {
+        m_statistics.Reset();
+    }
+
+protected:
+    Recorder& GetStatisticsRecorder() const {
+        return m_statistics;
+    }
+
+private:
+    mutable Recorder m_statistics;
+};
+
+template<>
+class HashMapStatisticsHolder<DisabledHashMapStatistics>
+{
+public:
+    DisabledHashMapStatistics GetStatistics() const {
+        return {};
+    }
+
+    void ResetStatistics() {}
+
+protected:
+    static DisabledHashMapStatistics GetStatisticsRecorder() {
+        return {};
+    }
+};
@@ -0,0 +1,312 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define HASHERS_CRC32C_HARDWARE 1
+#include <nmmintrin.h>
+#define HASHERS_TARGET_SSE42 __attribute__((target("sse4.2")))
+#elif defined(_MSC_VER) && defined(_M_X64)
+#define HASHERS_CRC32C_HARDWARE 1
+#include <intrin.h>
+#include <nmmintrin.h>
+#define HASHERS_TARGET_SSE42
+#else
+#define HASHERS_CRC32C_HARDWARE 0
+#endif
+
+// Hashers for the hash maps. Single argument call gives a full width hash,
+// call with 'bytes' gives a hash of bytes * 8 bits for maps which index by it directly.
+
+namespace Hashing::detail
+{
+    constexpr uint64_t GoldenRatio = 0x9E3779B97F4A7C15ull;
+
+    // wyhash secret: odd constants with balanced bits
+    constexpr uint64_t Secret[4]{
+        0x2d358dccaa6c78a5ull,
+        0x8bb84b93962eacc9ull,
+        0x4b33a62ed433d4a3ull,
+        0x4d5a2da51de1aa47ull
+    };
+
+    // Full 128 bit product: low half to 'a', high half to 'b'
+    inline void MultiplyFull(uint64_t& a, uint64_t& b) {
+#if defined(__SIZEOF_INT128__)
+        const unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+        a = static_cast<uint64_t>(product);
+        b = static_cast<uint64_t>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+        a = _umul128(a, b, &b);
+#else
+        const uint64_t aHigh = a >> 32, aLow = static_cast<uint32_t>(a);
+        const uint64_t bHigh = b >> 32, bLow = static_cast<uint32_t>(b);
+        const uint64_t highHigh = aHigh * bHigh, highLow = aHigh * bLow;
+        const uint64_t lowHigh = aLow * bHigh, lowLow = aLow * bLow;
+        const uint64_t middle = (lowLow >> 32) + static_cast<uint32_t>(highLow) + static_cast<uint32_t>(lowHigh);
+        a = (middle << 32) | static_cast<uint32_t>(lowLow);
+        b = highHigh + (highLow >> 32) + (lowHigh >> 32) + (middle >> 32);
+#endif
+    }
+
+    // Folded multiply: every bit of the result depends on every bit of both arguments
+    inline uint64_t MultiplyFold(uint64_t a, uint64_t b) {
+        MultiplyFull(a, b);
+        return a ^ b;
+    }
+
+    inline uint64_t Read8(const uint8_t* p) {
+        uint64_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    inline uint64_t Read4(const uint8_t* p) {
+        uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    // 1 to 3 bytes: first, middle and last one
+    inline uint64_t Read3(const uint8_t* p, size_t size) {
+        return (uint64_t{ p[0] } << 16) | (uint64_t{ p[size >> 1] } << 8) | p[size - 1];
+    }
+
+    // Reflected Castagnoli polynomial
+    constexpr uint32_t Crc32cPolynomial = 0x82F63B78u;
+
+    struct Crc32cTable
+    {
+        constexpr Crc32cTable() {
+            for (uint32_t i = 0; i < 256; ++i) {
+                uint32_t crc = i;
+                for (int bit = 0; bit < 8; ++bit) {
+                    crc = (crc >> 1) ^ ((crc & 1) ? Crc32cPolynomial : 0);
+                }
+                values[i] = crc;
+            }
+        }
+
+        uint32_t values[256]{};
+    };
+
+    inline constexpr Crc32cTable crc32cTable{};
+
+    inline uint32_t Crc32cSoftware(const uint8_t* p, size_t size, uint32_t crc) {
+        for (size_t i = 0; i < size; ++i) {
+            crc = (crc >> 8) ^ crc32cTable.values[(crc ^ p[i]) & 0xFF];
+        }
+        return crc;
+    }
+
+#if HASHERS_CRC32C_HARDWARE
+    HASHERS_TARGET_SSE42 inline uint32_t Crc32cHardware(const uint8_t* p, size_t size, uint32_t crc) {
+        uint64_t crc64 = crc;
+        for (; size >= 8; size -= 8, p += 8) {
+            crc64 = _mm_crc32_u64(crc64, Read8(p));
+        }
+        crc = static_cast<uint32_t>(crc64);
+        for (; size > 0; --size, ++p) {
+            crc = _mm_crc32_u8(crc, *p);
+        }
+        return crc;
+    }
+#endif
+}
+
+namespace Hashing
+{
+    /// wyhash (final version 4) of 'size' bytes
+    inline uint64_t WyHash(const void* data, size_t size, uint64_t seed = 0) {
+        using namespace detail;
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        seed ^= MultiplyFold(seed ^ Secret[0], Secret[1]);
+        uint64_t a;
+        uint64_t b;
+        if (size <= 16) {
+            if (size >= 4) {
+                const size_t offset = (size >> 3) << 2;
+                a = (Read4(p) << 32) | Read4(p + offset);
+                b = (Read4(p + size - 4) << 32) | Read4(p + size - 4 - offset);
+            }
+            else if (size > 0) {
+                a = Read3(p, size);
+                b = 0;
+            }
+            else {
+                a = b = 0;
+            }
+        }
+        else {
+            size_t left = size;
+            if (left > 48) {
+                // Three independent lanes hide multiplication latency
+                uint64_t seed1 = seed;
+                uint64_t seed2 = seed;
+                do {
+                    seed = MultiplyFold(Read8(p) ^ Secret[1], Read8(p + 8) ^ seed);
+                    seed1 = MultiplyFold(Read8(p + 16) ^ Secret[2], Read8(p + 24) ^ seed1);
+                    seed2 = MultiplyFold(Read8(p + 32) ^ Secret[3], Read8(p + 40) ^ seed2);
+                    p += 48;
+                    left -= 48;
+                } while (left > 48);
+                seed ^= seed1 ^ seed2;
+            }
+
+            while (left > 16) {
+                seed = MultiplyFold(Read8(p) ^ Secret[1], Read8(p + 8) ^ seed);
+                p += 16;
+                left -= 16;
+            }
+
+            // Last 16 bytes, may overlap already hashed ones
+            a = Read8(p + left - 16);
+            b = Read8(p + left - 8);
+        }
+
+        a ^= Secret[1];
+        b ^= seed;
+        MultiplyFull(a, b);
+        return MultiplyFold(a ^ Secret[0] ^ size, b ^ Secret[1]);
+    }
+
+    /// True if CRC32C is computed by the SSE4.2 instruction on this CPU
+    inline bool HasCrc32cInstruction() {
+#if HASHERS_CRC32C_HARDWARE && defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        return (info[2] & (1 << 20)) != 0;
+#elif HASHERS_CRC32C_HARDWARE
+        return __builtin_cpu_supports("sse4.2");
+#else
+        return false;
+#endif
+    }
+
+    /// CRC32C (Castagnoli) of 'size' bytes, 'crc' continues a previous call
+    inline uint32_t Crc32c(const void* data, size_t size, uint32_t crc = 0, bool hardware = HasCrc32cInstruction()) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        crc = ~crc;
+#if HASHERS_CRC32C_HARDWARE
+        if (hardware) {
+            return ~detail::Crc32cHardware(p, size, crc);
+        }
+#else
+        (void)hardware;
+#endif
+        return ~detail::Crc32cSoftware(p, size, crc);
+    }
+
+    /// Keeps the highest 'bytes' * 8 bits of a 'hashBits' wide hash: the best mixed ones for multiplicative hashes
+    inline size_t HighBits(uint64_t hash, size_t bytes, size_t hashBits = 64) {
+        assert(bytes > 0 && bytes * 8 <= hashBits);
+        return static_cast<size_t>(hash >> (hashBits - bytes * 8));
+    }
+}
+
+template
+<
+    typename T,
+    typename Enable = std::enable_if_t<std::is_integral_v<T>>
+>
+struct KnuthMultiplicativeMethod {
+    size_t operator()(T key, size_t bytes) const {
+        assert(bytes <= sizeof(key));
+        const size_t bits = bytes * 8;
+        const T hash = key * T{ 2654435761 };
+        return bits < sizeof(T) * 8 ? hash % (T{ 1 } << bits) : hash;
+    }
+
+    // Full width hash
+    size_t operator()(T key) const {
+        return static_cast<size_t>(key * T{ 2654435761 });
+    }
+};
+
+template
+<
+    typename T,
+    typename Enable = std::enable_if_t<std::is_integral_v<T>>
+>
+struct FirstNBitsHasher {
+    size_t operator()(T key, size_t bytes) const {
+        assert(bytes <= sizeof(key));
+        T result = 0;
+        std::memcpy(&result, &key, bytes);
+        return result;
+    }
+
+    // Full width hash
+    size_t operator()(T key) const {
+        return static_cast<size_t>(key);
+    }
+};
+
+// Fibonacci hashing: multiplication by 2^64 / golden ratio.
+// High bits of the product depend on all bits of the key, so they are the ones taken
+template
+<
+    typename T,
+    typename Enable = std::enable_if_t<std::is_integral_v<T>>
+>
+struct FibonacciHasher {
+    size_t operator()(T key, size_t bytes) const {
+        return Hashing::HighBits(static_cast<uint64_t>(key) * Hashing::detail::GoldenRatio, bytes);
+    }
+
+    // Full width hash: both halves of the 128 bit product folded together.
+    // Key is offset first, otherwise the high half is zero for small keys
+    size_t operator()(T key) const {
+        using namespace Hashing::detail;
+        return static_cast<size_t>(MultiplyFold(static_cast<uint64_t>(key) ^ Secret[0], GoldenRatio));
+    }
+};
+
+// wyhash of the key bytes, or of the characters for string keys
+template<typename T>
+struct WyHasher {
+    size_t operator()(const T& key, size_t bytes) const {
+        return Hashing::HighBits((*this)(key), bytes);
+    }
+
+    size_t operator()(const T& key) const {
+        if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            const std::string_view string = key;
+            return static_cast<size_t>(Hashing::WyHash(string.data(), string.size()));
+        }
+        else {
+            static_assert(std::is_trivially_copyable_v<T> && std::has_unique_object_representations_v<T>,
+                "Key bytes must define its value");
+            return static_cast<size_t>(Hashing::WyHash(&key, sizeof(key)));
+        }
+    }
+};
+
+// CRC32C of the key bytes: a single instruction per 8 bytes with SSE4.2.
+// The hash is only 32 bits wide and linear, use it with maps which mix it further
+template<typename T>
+struct Crc32cHasher {
+    size_t operator()(const T& key, size_t bytes) const {
+        return Hashing::HighBits((*this)(key), bytes, 32);
+    }
+
+    size_t operator()(const T& key) const {
+        if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            const std::string_view string = key;
+            return Hashing::Crc32c(string.data(), string.size(), 0, m_hardware);
+        }
+        else {
+            static_assert(std::is_trivially_copyable_v<T> && std::has_unique_object_representations_v<T>,
+                "Key bytes must define its value");
+            return Hashing::Crc32c(&key, sizeof(key), 0, m_hardware);
+        }
+    }
+
+private:
+    bool m_hardware = Hashing::HasCrc32cInstruction();
+};
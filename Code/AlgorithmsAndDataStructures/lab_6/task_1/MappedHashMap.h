@@ -0,0 +1,343 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Hashers.h"
+
+// Read only view of a whole file mapped into memory. Pages are loaded on first access
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string& path) {
+#if defined(_WIN32)
+        m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("Failed to open " + path);
+        }
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(m_file, &size)) {
+            Close();
+            throw std::runtime_error("Failed to get size of " + path);
+        }
+        m_size = static_cast<size_t>(size.QuadPart);
+
+        if (m_size != 0) {
+            m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            m_data = m_mapping ? MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+            if (m_data == nullptr) {
+                Close();
+                throw std::runtime_error("Failed to map " + path);
+            }
+        }
+#else
+        const int file = open(path.c_str(), O_RDONLY);
+        if (file == -1) {
+            throw std::runtime_error("Failed to open " + path);
+        }
+
+        struct stat status;
+        if (fstat(file, &status) != 0) {
+            close(file);
+            throw std::runtime_error("Failed to get size of " + path);
+        }
+        m_size = static_cast<size_t>(status.st_size);
+
+        if (m_size != 0) {
+            void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file, 0);
+            if (data == MAP_FAILED) {
+                close(file);
+                throw std::runtime_error("Failed to map " + path);
+            }
+            m_data = data;
+        }
+        // Mapping stays valid after the descriptor is closed
+        close(file);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        Close();
+    }
+
+    const uint8_t* GetData() const {
+        return static_cast<const uint8_t*>(m_data);
+    }
+
+    size_t GetSize() const {
+        return m_size;
+    }
+
+private:
+    void Close() {
+#if defined(_WIN32)
+        if (m_data != nullptr) {
+            UnmapViewOfFile(m_data);
+        }
+        if (m_mapping != nullptr) {
+            CloseHandle(m_mapping);
+        }
+        if (m_file != INVALID_HANDLE_VALUE) {
+            CloseHandle(m_file);
+        }
+#else
+        if (m_data != nullptr) {
+            munmap(m_data, m_size);
+        }
+#endif
+        m_data = nullptr;
+    }
+
+private:
+    void* m_data = nullptr;
+    size_t m_size = 0;
+#if defined(_WIN32)
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+#endif
+};
+
+// File header of MappedHashMap. Offsets are from the file start, so the file can be mapped at any address
+struct MappedHashMapHeader
+{
+    // "AADSHMAP" read as little endian number: a file of other byte order does not match
+    static constexpr uint64_t Magic = 0x50414D4853444141ull;
+    static constexpr uint32_t CurrentVersion = 1;
+
+    uint64_t magic;
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t keySize;
+    uint32_t valueSize;
+    uint64_t capacity;
+    uint64_t size;
+    uint64_t controlOffset;
+    uint64_t keysOffset;
+    uint64_t valuesOffset;
+    uint64_t fileSize;
+    // CRC32C of the file after the header
+    uint32_t dataChecksum;
+    // CRC32C of the header up to this field
+    uint32_t headerChecksum;
+};
+
+// Read optimized hash map stored in a file and used in place: opening maps the file and checks
+// the header only, so it takes the same time for any table size, pages are read on first access.
+// Layout after the header: control bytes, keys, values, each array aligned to a cache line.
+// Control byte is zero for an empty slot or 0x80 | 7 bits of hash, so most mismatches don't touch keys.
+// Slots are found by linear probing from the hash masked by power of two capacity.
+// Keys and values are stored as raw bytes and the hasher must give the same hashes in every process
+template
+<
+    typename Key,
+    typename Value,
+    typename Hasher
+>
+class MappedHashMap
+{
+    static_assert(std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Value>,
+        "Keys and values are stored as raw bytes");
+
+private:
+    struct Hash
+    {
+        size_t index;
+        uint8_t control;
+    };
+
+    using Header = MappedHashMapHeader;
+
+    static constexpr size_t Alignment = 64;
+    // Load factor of written tables: probes of a read optimized table stay short
+    static constexpr size_t MaxLoadPercent = 50;
+
+public:
+    /// Maps the file written by Write. Throws std::runtime_error if it is not a valid table of these types
+    explicit MappedHashMap(const std::string& path) :
+        m_file(path)
+    {
+        if (m_file.GetSize() < sizeof(Header)) {
+            throw std::runtime_error("File is too small for hash map header: " + path);
+        }
+
+        std::memcpy(&m_header, m_file.GetData(), sizeof(Header));
+        if (m_header.magic != Header::Magic) {
+            throw std::runtime_error("File is not a hash map: " + path);
+        }
+        if (m_header.version != Header::CurrentVersion || m_header.headerSize != sizeof(Header)) {
+            throw std::runtime_error("Unsupported hash map version: " + path);
+        }
+        if (m_header.headerChecksum != ComputeHeaderChecksum(m_header)) {
+            throw std::runtime_error("Hash map header is corrupted: " + path);
+        }
+        if (m_header.keySize != sizeof(Key) || m_header.valueSize != sizeof(Value)) {
+            throw std::runtime_error("Hash map has other key or value type: " + path);
+        }
+
+        const uint64_t capacity = m_header.capacity;
+        const bool validLayout =
+            capacity != 0 && (capacity & (capacity - 1)) == 0 &&
+            m_header.size <= capacity &&
+            m_header.fileSize == m_file.GetSize() &&
+            m_header.controlOffset >= sizeof(Header) && RegionFits(m_header.controlOffset, capacity, 1, m_header.keysOffset) &&
+            RegionFits(m_header.keysOffset, capacity, sizeof(Key), m_header.valuesOffset) &&
+            RegionFits(m_header.valuesOffset, capacity, sizeof(Value), m_header.fileSize) &&
+            m_header.keysOffset % alignof(Key) == 0 && m_header.valuesOffset % alignof(Value) == 0;
+        if (!validLayout) {
+            throw std::runtime_error("Hash map layout does not match file: " + path);
+        }
+
+        const uint8_t* data = m_file.GetData();
+        m_control = data + m_header.controlOffset;
+        m_keys = reinterpret_cast<const Key*>(data + m_header.keysOffset);
+        m_values = reinterpret_cast<const Value*>(data + m_header.valuesOffset);
+        m_mask = static_cast<size_t>(capacity - 1);
+    }
+
+    /// Writes 'count' elements as a table file. Throws std::runtime_error on duplicate keys or write failure
+    static void Write(const std::string& path, const std::pair<Key, Value>* elements, size_t count) {
+        size_t capacity = Alignment;
+        while (capacity * MaxLoadPercent / 100 < count) {
+            capacity *= 2;
+        }
+
+        std::vector<uint8_t> control(capacity, 0);
+        std::vector<Key> keys(capacity);
+        std::vector<Value> values(capacity);
+        const Hasher hasher{};
+        for (size_t i = 0; i < count; ++i) {
+            const auto& [key, value] = elements[i];
+            const Hash hash = GetHash(hasher, key, capacity - 1);
+            size_t index = hash.index;
+            while (control[index] != 0) {
+                if (control[index] == hash.control && keys[index] == key) {
+                    throw std::runtime_error("Duplicate key in hash map elements");
+                }
+                index = (index + 1) & (capacity - 1);
+            }
+            control[index] = hash.control;
+            keys[index] = key;
+            values[index] = value;
+        }
+
+        Header header{};
+        header.magic = Header::Magic;
+        header.version = Header::CurrentVersion;
+        header.headerSize = sizeof(Header);
+        header.keySize = sizeof(Key);
+        header.valueSize = sizeof(Value);
+        header.capacity = capacity;
+        header.size = count;
+        header.controlOffset = AlignUp(sizeof(Header));
+        header.keysOffset = AlignUp(header.controlOffset + capacity);
+        header.valuesOffset = AlignUp(header.keysOffset + capacity * sizeof(Key));
+        header.fileSize = header.valuesOffset + capacity * sizeof(Value);
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            throw std::runtime_error("Failed to create " + path);
+        }
+
+        // Header is written last: its checksum covers the data written after it
+        file.seekp(static_cast<std::streamoff>(sizeof(Header)));
+        uint32_t checksum = 0;
+        uint64_t offset = sizeof(Header);
+        auto writeSection = [&](uint64_t sectionOffset, const void* data, size_t size) {
+            static const uint8_t zeros[Alignment]{};
+            checksum = Hashing::Crc32c(zeros, static_cast<size_t>(sectionOffset - offset), checksum);
+            file.write(reinterpret_cast<const char*>(zeros), static_cast<std::streamsize>(sectionOffset - offset));
+            checksum = Hashing::Crc32c(data, size, checksum);
+            file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+            offset = sectionOffset + size;
+        };
+        writeSection(header.controlOffset, control.data(), control.size());
+        writeSection(header.keysOffset, keys.data(), keys.size() * sizeof(Key));
+        writeSection(header.valuesOffset, values.data(), values.size() * sizeof(Value));
+
+        header.dataChecksum = checksum;
+        header.headerChecksum = ComputeHeaderChecksum(header);
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        if (!file.flush()) {
+            throw std::runtime_error("Failed to write " + path);
+        }
+    }
+
+    /// Probes are bounded by capacity: a damaged file without empty slots can't loop forever
+    const Value* Find(const Key& key) const {
+        const Hash hash = GetHash(m_hasher, key, m_mask);
+        for (size_t probe = 0, index = hash.index; probe <= m_mask && m_control[index] != 0; ++probe, index = (index + 1) & m_mask) {
+            if (m_control[index] == hash.control && m_keys[index] == key) {
+                return &m_values[index];
+            }
+        }
+        return nullptr;
+    }
+
+    /// Reads the whole file: use it when the file may be damaged, opening does not
+    bool VerifyChecksum() const {
+        const size_t dataSize = m_file.GetSize() - sizeof(Header);
+        return Hashing::Crc32c(m_file.GetData() + sizeof(Header), dataSize) == m_header.dataChecksum;
+    }
+
+    size_t GetSize() const {
+        return static_cast<size_t>(m_header.size);
+    }
+
+    size_t GetCapacity() const {
+        return m_mask + 1;
+    }
+
+private:
+    // Index from the low bits of the mixed hash, control byte from the high ones
+    static Hash GetHash(const Hasher& hasher, const Key& key, size_t mask) {
+        const uint64_t mixed = static_cast<uint64_t>(hasher(key)) * 0x9E3779B97F4A7C15ull;
+        return Hash{ static_cast<size_t>(mixed ^ (mixed >> 32)) & mask, static_cast<uint8_t>(0x80 | (mixed >> 57)) };
+    }
+
+    static uint32_t ComputeHeaderChecksum(const Header& header) {
+        return Hashing::Crc32c(&header, offsetof(Header, headerChecksum));
+    }
+
+    // 'count' elements of 'elementSize' bytes from 'offset' end at or before 'end'.
+    // Divides instead of multiplying, so offsets and capacity of a corrupted header can't overflow
+    static bool RegionFits(uint64_t offset, uint64_t count, uint64_t elementSize, uint64_t end) {
+        return offset <= end && count <= (end - offset) / elementSize;
+    }
+
+    static uint64_t AlignUp(uint64_t offset) {
+        return (offset + Alignment - 1) / Alignment * Alignment;
+    }
+
+private:
+    MappedFile m_file;
+    Header m_header;
+    Hasher m_hasher;
+    const uint8_t* m_control = nullptr;
+    const Key* m_keys = nullptr;
+    const Value* m_values = nullptr;
+    size_t m_mask = 0;
+};
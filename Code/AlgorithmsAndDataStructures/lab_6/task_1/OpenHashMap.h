@@ -3,6 +3,9 @@
 #include <algorithm>
 #include <vector>
 
+#include "HashMapStatistics.h"
+#include "Prefetch.h"
+
 template
 <
     typename Key,
@@ -37,12 +40,23 @@ public:
 
     const Value* Find(const Key& key) const {
         const auto it = LowerBound(key);
-        if (IteratorPointsToKey(key)) {
+        if (IteratorPointsToKey(it, key)) {
             return &it->second;
         }
         return nullptr;
     }
 
+    size_t GetSize() const {
+        return m_values.size();
+    }
+
+    /// Binary search starts in the middle of the bucket
+    void PrefetchValues() const {
+        if (!m_values.empty()) {
+            Prefetch(m_values.data() + m_values.size() / 2);
+        }
+    }
+
 private:
     Iterator LowerBound(const Key key) {
         return std::lower_bound(m_values.begin(), m_values.end(), key, [](auto& keyval, const Key& key) {
@@ -73,7 +87,7 @@ template
     typename Value,
     typename Hasher
 >
-class OpenHashMap
+class OpenHashMap : private HashMapStatisticsHolder<HashMapStatisticsRecorder>
 {
 private:
     struct Hash
@@ -81,7 +95,7 @@ private:
         size_t value;
     };
 
-    using Bucket = Bucket<Key, Value>;
+    using KeyBucket = Bucket<Key, Value>;
 
 public:
     OpenHashMap(size_t bucketsCount)
@@ -91,37 +105,82 @@ public:
 
     template<typename... Args>
     Value* Emplace(Key key, Args&&... args) {
-        Bucket& bucket = GetBucket(key);
+        KeyBucket& bucket = GetBucket(key);
+        GetStatisticsRecorder().RecordProbes(HashMapOperation::Emplace, bucket.GetSize());
         return bucket.TryEmplace(key, std::forward<Args>(args)...);
     }
 
     Value* Find(const Key& key) {
-        Bucket& bucket = GetBucket(key);
-        return bucket.Find(key);
+        KeyBucket& bucket = GetBucket(key);
+        return RecordFind(bucket, bucket.Find(key));
     }
 
     const Value* Find(const Key& key) const {
-        Bucket& bucket = GetBucket(key);
-        return bucket.Find(key);
+        const KeyBucket& bucket = GetBucket(key);
+        return RecordFind(bucket, bucket.Find(key));
+    }
+
+    /// Sets values[i] to the value of keys[i] or nullptr.
+    /// Keys are resolved by groups in three passes: the first prefetches buckets,
+    /// the second (buckets are loaded by then) prefetches their elements, the third searches.
+    /// Cache misses of a group overlap instead of following one another
+    void FindBatch(const Key* keys, size_t count, Value** values) {
+        KeyBucket* buckets[PrefetchGroupSize];
+        for (size_t groupBegin = 0; groupBegin < count; groupBegin += PrefetchGroupSize) {
+            const size_t groupSize = std::min(PrefetchGroupSize, count - groupBegin);
+            for (size_t i = 0; i < groupSize; ++i) {
+                buckets[i] = &GetBucket(keys[groupBegin + i]);
+                Prefetch(buckets[i]);
+            }
+
+            for (size_t i = 0; i < groupSize; ++i) {
+                buckets[i]->PrefetchValues();
+            }
+
+            for (size_t i = 0; i < groupSize; ++i) {
+                values[groupBegin + i] = RecordFind(*buckets[i], buckets[i]->Find(keys[groupBegin + i]));
+            }
+        }
+    }
+
+    /// Count of buckets of each size
+    LengthHistogram GetBucketSizeHistogram() const {
+        LengthHistogram histogram;
+        for (const KeyBucket& bucket : m_buckets) {
+            histogram.Add(bucket.GetSize());
+        }
+        return histogram;
     }
 
+    /// Probe lengths recorded since construction or the last reset, a probe length is the size
+    /// of the searched bucket. Buckets count is fixed, so there are no resizes.
+    /// Empty unless HASH_MAP_STATISTICS is enabled
+    using HashMapStatisticsHolder::GetStatistics;
+    using HashMapStatisticsHolder::ResetStatistics;
+
 private:
+    template<typename ValuePointer>
+    ValuePointer RecordFind(const KeyBucket& bucket, ValuePointer value) const {
+        GetStatisticsRecorder().RecordProbes(value ? HashMapOperation::Find : HashMapOperation::FindMissing, bucket.GetSize());
+        return value;
+    }
+
     Hash GetHash(const Key& key) const {
         const size_t value = m_hasher(key) % m_buckets.size();
         return Hash{ value };
     }
 
-    Bucket& GetBucket(const Key& key) {
+    KeyBucket& GetBucket(const Key& key) {
         const Hash hash = GetHash(key);
         return m_buckets[hash.value];
     }
 
-    const Bucket& GetBucket(const Key& key) const {
+    const KeyBucket& GetBucket(const Key& key) const {
         const Hash hash = GetHash(key);
         return m_buckets[hash.value];
     }
 
 private:
     Hasher m_hasher;
-    std::vector<Bucket> m_buckets;
+    std::vector<KeyBucket> m_buckets;
 };
\ No newline at end of file
@@ -0,0 +1,375 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "Hashers.h"
+#include "Prefetch.h"
+#include "Thread/ThreadPool.h"
+
+// Read only hash map over a fixed key set built with a minimal perfect hash function (PTHash scheme).
+// Keys are split into partitions built independently on a thread pool. Inside a partition keys are
+// hashed into small buckets, 60% of keys into 30% of buckets, and each bucket gets a 16 bit pilot:
+// the first value which, mixed with the keys' hashes, puts all of them into free slots. Buckets are
+// placed from the largest one, while the table is still empty. Slots are searched in a table 1% larger
+// than the partition, positions past its end are remapped to the free slots left before it.
+// A lookup reads one pilot and then one slot, and never probes further
+template
+<
+    typename Key,
+    typename Value,
+    typename Hasher
+>
+class PerfectHashMap
+{
+private:
+    struct Entry
+    {
+        Key key;
+        Value value;
+    };
+
+    struct Partition
+    {
+        size_t entriesOffset;
+        size_t pilotsOffset;
+        size_t freeSlotsOffset;
+        uint32_t size;
+        uint32_t tableSize;
+        uint32_t bucketsCount;
+        uint32_t denseBucketsCount;
+    };
+
+    enum class BuildStatus
+    {
+        Done,
+        DuplicateKey,
+        EqualHashes,
+        NoPilot
+    };
+
+    using Pilot = uint16_t;
+
+    static constexpr size_t NoEntry = std::numeric_limits<size_t>::max();
+
+    static constexpr size_t PartitionSize = 1 << 16;
+    static constexpr size_t AverageBucketSize = 4;
+    static constexpr size_t TableSizePercent = 101;
+    static constexpr size_t HashingTaskSize = 1 << 16;
+
+public:
+    /// Builds the table of 'count' elements on 'threadsCount' threads, all hardware threads if zero.
+    /// Throws std::runtime_error on duplicate keys or different keys with equal hashes
+    PerfectHashMap(const std::pair<Key, Value>* elements, size_t count, size_t threadsCount = 0) {
+        if (count == 0) {
+            return;
+        }
+        if (count > std::numeric_limits<uint32_t>::max()) {
+            throw std::runtime_error("Too many elements for perfect hash map");
+        }
+
+        std::vector<uint64_t> hashes(count);
+        RunTasks(threadsCount, (count + HashingTaskSize - 1) / HashingTaskSize, [&](size_t task) {
+            const size_t end = std::min(count, (task + 1) * HashingTaskSize);
+            for (size_t i = task * HashingTaskSize; i < end; ++i) {
+                hashes[i] = GetHash(elements[i].first);
+            }
+        });
+
+        // Group elements by partitions and lay out the partitions' parts of the arrays one after another
+        m_partitions.resize(std::max<size_t>(1, count / PartitionSize));
+        std::vector<size_t> partitionBegins(m_partitions.size() + 1, 0);
+        for (uint64_t hash : hashes) {
+            ++partitionBegins[GetPartitionIndex(hash) + 1];
+        }
+
+        size_t pilotsCount = 0;
+        size_t freeSlotsCount = 0;
+        for (size_t i = 0; i < m_partitions.size(); ++i) {
+            Partition& partition = m_partitions[i];
+            partition.size = static_cast<uint32_t>(partitionBegins[i + 1]);
+            partition.tableSize = static_cast<uint32_t>(std::max<size_t>(1, (partition.size * TableSizePercent + 99) / 100));
+            partition.bucketsCount = static_cast<uint32_t>(std::max<size_t>(1, partition.size / AverageBucketSize));
+            partition.denseBucketsCount = static_cast<uint32_t>(partition.bucketsCount * 3 / 10);
+            partition.entriesOffset = partitionBegins[i];
+            partition.pilotsOffset = pilotsCount;
+            partition.freeSlotsOffset = freeSlotsCount;
+            pilotsCount += partition.bucketsCount;
+            freeSlotsCount += partition.tableSize - partition.size;
+            partitionBegins[i + 1] += partitionBegins[i];
+        }
+
+        std::vector<uint32_t> order(count);
+        {
+            std::vector<size_t> positions(partitionBegins.begin(), partitionBegins.end() - 1);
+            for (size_t i = 0; i < count; ++i) {
+                order[positions[GetPartitionIndex(hashes[i])]++] = static_cast<uint32_t>(i);
+            }
+        }
+
+        m_entries.resize(count);
+        m_pilots.resize(pilotsCount);
+        m_freeSlots.resize(freeSlotsCount);
+        std::vector<BuildStatus> statuses(m_partitions.size(), BuildStatus::Done);
+        RunTasks(threadsCount, m_partitions.size(), [&](size_t i) {
+            statuses[i] = BuildPartition(m_partitions[i], elements, hashes, &order[partitionBegins[i]]);
+        });
+
+        for (BuildStatus status : statuses) {
+            switch (status) {
+            case BuildStatus::Done:
+                break;
+            case BuildStatus::DuplicateKey:
+                throw std::runtime_error("Duplicate key in perfect hash map elements");
+            case BuildStatus::EqualHashes:
+                throw std::runtime_error("Different keys have equal hashes, perfect hash map needs a better hasher");
+            case BuildStatus::NoPilot:
+                throw std::runtime_error("Failed to find pilot of perfect hash map bucket");
+            }
+        }
+    }
+
+    const Value* Find(const Key& key) const {
+        if (m_entries.empty()) {
+            return nullptr;
+        }
+
+        const uint64_t hash = GetHash(key);
+        const Partition& partition = m_partitions[GetPartitionIndex(hash)];
+        if (partition.size == 0) {
+            return nullptr;
+        }
+
+        const Entry& entry = m_entries[partition.entriesOffset + GetSlotIndex(hash, partition)];
+        return entry.key == key ? &entry.value : nullptr;
+    }
+
+    /// Sets values[i] to the value of keys[i] or nullptr.
+    /// Keys are resolved by groups in three passes: the first prefetches pilots,
+    /// the second (pilots are loaded by then) prefetches entries, the third compares keys
+    void FindBatch(const Key* keys, size_t count, const Value** values) const {
+        if (m_entries.empty()) {
+            std::fill(values, values + count, nullptr);
+            return;
+        }
+
+        uint64_t hashes[PrefetchGroupSize];
+        const Partition* partitions[PrefetchGroupSize];
+        size_t entryIndices[PrefetchGroupSize];
+        for (size_t groupBegin = 0; groupBegin < count; groupBegin += PrefetchGroupSize) {
+            const size_t groupSize = std::min(PrefetchGroupSize, count - groupBegin);
+            for (size_t i = 0; i < groupSize; ++i) {
+                hashes[i] = GetHash(keys[groupBegin + i]);
+                partitions[i] = &m_partitions[GetPartitionIndex(hashes[i])];
+                Prefetch(&m_pilots[partitions[i]->pilotsOffset + GetBucketIndex(hashes[i], *partitions[i])]);
+            }
+
+            for (size_t i = 0; i < groupSize; ++i) {
+                const Partition& partition = *partitions[i];
+                entryIndices[i] = partition.size != 0 ? partition.entriesOffset + GetSlotIndex(hashes[i], partition) : NoEntry;
+                if (entryIndices[i] != NoEntry) {
+                    Prefetch(&m_entries[entryIndices[i]]);
+                }
+            }
+
+            for (size_t i = 0; i < groupSize; ++i) {
+                const Entry* entry = entryIndices[i] != NoEntry ? &m_entries[entryIndices[i]] : nullptr;
+                values[groupBegin + i] = entry && entry->key == keys[groupBegin + i] ? &entry->value : nullptr;
+            }
+        }
+    }
+
+    size_t GetSize() const {
+        return m_entries.size();
+    }
+
+    /// Memory taken besides the elements: pilots, remapped slots and partitions
+    double GetBitsPerKey() const {
+        const size_t bytes = m_pilots.size() * sizeof(Pilot) + m_freeSlots.size() * sizeof(uint32_t) +
+            m_partitions.size() * sizeof(Partition);
+        return m_entries.empty() ? 0. : static_cast<double>(bytes * 8) / static_cast<double>(m_entries.size());
+    }
+
+private:
+    // Multiplication by an odd number and xor shift are bijections: hashes are equal only for equal hasher outputs
+    uint64_t GetHash(const Key& key) const {
+        const uint64_t mixed = static_cast<uint64_t>(m_hasher(key)) * Hashing::detail::GoldenRatio;
+        return mixed ^ (mixed >> 32);
+    }
+
+    // Maps a hash to [0, n) by the high half of the product, no division
+    static size_t Reduce(uint64_t hash, size_t n) {
+        uint64_t high = n;
+        Hashing::detail::MultiplyFull(hash, high);
+        return static_cast<size_t>(high);
+    }
+
+    size_t GetPartitionIndex(uint64_t hash) const {
+        return Reduce(hash, m_partitions.size());
+    }
+
+    // Low bits choose between dense and sparse buckets, high bits the bucket itself
+    static size_t GetBucketIndex(uint64_t hash, const Partition& partition) {
+        const uint64_t bucketHash = Hashing::detail::MultiplyFold(hash, Hashing::detail::Secret[1]);
+        constexpr uint32_t denseKeysThreshold = static_cast<uint32_t>(0.6 * std::numeric_limits<uint32_t>::max());
+        if (static_cast<uint32_t>(bucketHash) < denseKeysThreshold && partition.denseBucketsCount != 0) {
+            return Reduce(bucketHash, partition.denseBucketsCount);
+        }
+        return partition.denseBucketsCount + Reduce(bucketHash, partition.bucketsCount - partition.denseBucketsCount);
+    }
+
+    static size_t GetSlotIndex(uint64_t hash, Pilot pilot, const Partition& partition) {
+        using namespace Hashing::detail;
+        return Reduce(MultiplyFold(hash ^ (pilot * GoldenRatio), Secret[2]), partition.tableSize);
+    }
+
+    // Final slot of a key in the partition: one pilot read and, for 1% of keys, one remapping read
+    size_t GetSlotIndex(uint64_t hash, const Partition& partition) const {
+        const Pilot pilot = m_pilots[partition.pilotsOffset + GetBucketIndex(hash, partition)];
+        const size_t slot = GetSlotIndex(hash, pilot, partition);
+        return slot < partition.size ? slot : m_freeSlots[partition.freeSlotsOffset + slot - partition.size];
+    }
+
+    // Runs fn(0) ... fn(tasksCount - 1) on a thread pool and waits for all of them
+    template<typename Fn>
+    static void RunTasks(size_t threadsCount, size_t tasksCount, const Fn& fn) {
+        ThreadPool<void> pool;
+        pool.SetDesiredThreadsCount(std::min(threadsCount != 0 ? threadsCount : std::thread::hardware_concurrency(), tasksCount));
+        for (size_t task = 0; task < tasksCount; ++task) {
+            pool.AddTask([&fn, task]() {
+                fn(task);
+            });
+        }
+        pool.Start();
+        pool.StopAndWait();
+    }
+
+    // Writes the partition's pilots, remapped slots and entries; 'order' lists its elements
+    BuildStatus BuildPartition(const Partition& partition, const std::pair<Key, Value>* elements,
+        const std::vector<uint64_t>& hashes, const uint32_t* order)
+    {
+        // Elements sorted by buckets, equal hashes end up next to each other
+        std::vector<std::pair<uint64_t, uint32_t>> bucketElements(partition.size);
+        std::vector<uint32_t> bucketBegins(partition.bucketsCount + 1, 0);
+        for (size_t i = 0; i < partition.size; ++i) {
+            ++bucketBegins[GetBucketIndex(hashes[order[i]], partition) + 1];
+        }
+        for (size_t bucket = 0; bucket < partition.bucketsCount; ++bucket) {
+            bucketBegins[bucket + 1] += bucketBegins[bucket];
+        }
+        {
+            std::vector<uint32_t> positions(bucketBegins.begin(), bucketBegins.end() - 1);
+            for (size_t i = 0; i < partition.size; ++i) {
+                const uint64_t hash = hashes[order[i]];
+                bucketElements[positions[GetBucketIndex(hash, partition)]++] = { hash, order[i] };
+            }
+        }
+
+        size_t maxBucketSize = 0;
+        for (size_t bucket = 0; bucket < partition.bucketsCount; ++bucket) {
+            const auto begin = bucketElements.begin() + bucketBegins[bucket];
+            const auto end = bucketElements.begin() + bucketBegins[bucket + 1];
+            std::sort(begin, end);
+            for (auto it = begin; it != end && it + 1 != end; ++it) {
+                if (it->first == (it + 1)->first) {
+                    const bool equalKeys = elements[it->second].first == elements[(it + 1)->second].first;
+                    return equalKeys ? BuildStatus::DuplicateKey : BuildStatus::EqualHashes;
+                }
+            }
+            maxBucketSize = std::max<size_t>(maxBucketSize, end - begin);
+        }
+
+        // Largest buckets first: counting sort by size
+        std::vector<uint32_t> bucketsOrder(partition.bucketsCount);
+        {
+            std::vector<uint32_t> sizeBegins(maxBucketSize + 2, 0);
+            for (size_t bucket = 0; bucket < partition.bucketsCount; ++bucket) {
+                ++sizeBegins[maxBucketSize - (bucketBegins[bucket + 1] - bucketBegins[bucket]) + 1];
+            }
+            for (size_t i = 0; i <= maxBucketSize; ++i) {
+                sizeBegins[i + 1] += sizeBegins[i];
+            }
+            for (size_t bucket = 0; bucket < partition.bucketsCount; ++bucket) {
+                bucketsOrder[sizeBegins[maxBucketSize - (bucketBegins[bucket + 1] - bucketBegins[bucket])]++] = static_cast<uint32_t>(bucket);
+            }
+        }
+
+        Pilot* pilots = &m_pilots[partition.pilotsOffset];
+        std::vector<uint32_t> elementSlots(partition.size);
+        std::vector<bool> taken(partition.tableSize, false);
+        for (uint32_t bucket : bucketsOrder) {
+            const size_t begin = bucketBegins[bucket];
+            const size_t end = bucketBegins[bucket + 1];
+            if (begin == end) {
+                pilots[bucket] = 0;
+                continue;
+            }
+
+            bool placed = false;
+            for (size_t pilot = 0; pilot <= std::numeric_limits<Pilot>::max() && !placed; ++pilot) {
+                // Take slots one by one, give them back if one is already taken
+                size_t i = begin;
+                for (; i < end; ++i) {
+                    const size_t slot = GetSlotIndex(bucketElements[i].first, static_cast<Pilot>(pilot), partition);
+                    if (taken[slot]) {
+                        break;
+                    }
+                    taken[slot] = true;
+                    elementSlots[i] = static_cast<uint32_t>(slot);
+                }
+
+                placed = i == end;
+                if (placed) {
+                    pilots[bucket] = static_cast<Pilot>(pilot);
+                }
+                else {
+                    while (i-- > begin) {
+                        taken[elementSlots[i]] = false;
+                    }
+                }
+            }
+
+            if (!placed) {
+                return BuildStatus::NoPilot;
+            }
+        }
+
+        // Slots past the partition size go to the free ones before it, in order
+        uint32_t* freeSlots = m_freeSlots.data() + partition.freeSlotsOffset;
+        size_t freeSlot = 0;
+        for (size_t slot = partition.size; slot < partition.tableSize; ++slot) {
+            if (taken[slot]) {
+                while (taken[freeSlot]) {
+                    ++freeSlot;
+                }
+                freeSlots[slot - partition.size] = static_cast<uint32_t>(freeSlot++);
+            }
+            else {
+                freeSlots[slot - partition.size] = 0;
+            }
+        }
+
+        for (size_t i = 0; i < partition.size; ++i) {
+            size_t slot = elementSlots[i];
+            if (slot >= partition.size) {
+                slot = freeSlots[slot - partition.size];
+            }
+            const auto& [key, value] = elements[bucketElements[i].second];
+            m_entries[partition.entriesOffset + slot] = Entry{ key, value };
+        }
+
+        return BuildStatus::Done;
+    }
+
+private:
+    Hasher m_hasher;
+    std::vector<Partition> m_partitions;
+    std::vector<Pilot> m_pilots;
+    std::vector<uint32_t> m_freeSlots;
+    std::vector<Entry> m_entries;
+};
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+
+#if defined(_MSC_VER) && !defined(__clang__) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
+/// Keys resolved together by batched lookups: enough cache misses in flight to hide memory latency,
+/// few enough for the prefetched lines to stay in L1 until they are used
+constexpr size_t PrefetchGroupSize = 16;
+
+/// Hint to start loading the cache line of 'address' ahead of its use
+inline void Prefetch(const void* address) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#else
+    (void)address;
+#endif
+}
@@ -1,56 +1,32 @@
 #include <array>
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <chrono>
+#include <cmath>
 #include <cstdint>
+#include <filesystem>
+#include <functional>
 #include <iostream>
+#include <mutex>
 #include <optional>
 #include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
 #include <vector>
 
 #include "ClosedHashMap.h"
-
-template
-<
-    typename T,
-    typename Enable = std::enable_if_t<std::is_integral_v<T>>
->
-struct KnuthMultiplicativeMethod {
-    size_t operator()(T key, size_t bytes) const {
-        assert(bytes <= sizeof(key));
-        const size_t bits = bytes * 8;
-        return (key * T{ 2654435761 }) % (T{ 1 } << bits);
-    }
-
-    size_t operator()(T key) const {
-        constexpr size_t bytes = 2;
-        constexpr size_t bits = bytes * 8;
-        assert(bytes <= sizeof(key));
-        return (key * T{ 2654435761 }) % (T{ 1 } << bits);
-    }
-};
-
-template
-<
-    typename T,
-    typename Enable = std::enable_if_t<std::is_integral_v<T>>
->
-struct FirstNBitsHasher {
-    size_t operator()(T key, size_t bytes) const {
-        assert(bytes <= sizeof(key));
-        T result = 0;
-        std::memcpy(&result, &key, bytes);
-        return result;
-    }
-
-    size_t operator()(T key) const {
-        assert(bytes <= sizeof(key));
-        T result = 0;
-        constexpr size_t bytes = 2;
-        std::memcpy(&result, &key, bytes);
-        return result;
-    }
-};
+#include "ConcurrentHashMap.h"
+#include "CuckooHashMap.h"
+#include "FlatHashMap.h"
+#include "Hashers.h"
+#include "MappedHashMap.h"
+#include "OpenHashMap.h"
+#include "PerfectHashMap.h"
+#include "Thread/ThreadPool.h"
+#include "workload_lib/WorkloadGenerator.h"
 
 #ifdef _DEBUG
 constexpr bool validateHashMap = true;
@@ -64,10 +40,96 @@ using Duration = std::chrono::nanoseconds;
 using DurationU = long double;
 using Clock = std::chrono::high_resolution_clock;
 
+template<typename Probing, typename Layout = InterleavedLayout>
+using HashMap = ClosedHashMap<Key, Value, KnuthMultiplicativeMethod<Key>, Probing, Layout>;
+using SwissHashMap = FlatHashMap<Key, Value, KnuthMultiplicativeMethod<Key>>;
+using CuckooMap = CuckooHashMap<Key, Value, KnuthMultiplicativeMethod<Key>>;
+
+// Linear probing, quadratic probing, Swiss table, linear probing with rehash, Robin Hood, cuckoo,
+// linear probing with keys and values in separate arrays
+constexpr size_t mapsCount = 7;
+using StepDurations = std::array<DurationU, mapsCount>;
+
+// Shrinking after erases must keep every element reachable: quadratic probing reaches only part
+// of a table, so a table above half full may have no free slot on a probe sequence
 template<typename Probing>
-using HashMap = ClosedHashMap<Key, Value, KnuthMultiplicativeMethod<Key>, Probing>;
+void CheckShrinkToFit() {
+    constexpr Key keysCount = 20;
+    constexpr Key erasedCount = 13;
+    HashMap<Probing> map(1);
+    map.SetMaxLoadFactor(1.f);
+    for (Key key = 0; key < keysCount; ++key) {
+        map.Emplace(key, static_cast<Value>(key));
+    }
+    for (Key key = 0; key < erasedCount; ++key) {
+        map.Erase(key);
+    }
+
+    map.ShrinkToFit();
+    for (Key key = 0; key < keysCount; ++key) {
+        const Value* pValue = map.Find(key);
+        if ((pValue != nullptr) != (key >= erasedCount) || (pValue != nullptr && *pValue != static_cast<Value>(key))) {
+            throw std::runtime_error("Shrink to fit lost or kept wrong elements");
+        }
+    }
+}
+
+// Generators used by the key distribution benchmark produce what they promise: sequential and clustered keys
+// have their shape, Zipf lookups hit key k about (k + 1)^exponent times less often than the most popular one
+void CheckWorkloads() {
+    constexpr size_t count = 1 << 12;
+    constexpr size_t clusterSize = 64;
+    constexpr Key min = 1000;
+    constexpr Key max = 1000 + 64 * count - 1;
+    constexpr uint64_t seed = 42;
+
+    std::vector<Key> keys;
+    Workload::GenerateSequentialKeys(keys, count, min, 3);
+    for (size_t i = 0; i < count; ++i) {
+        if (keys[i] != min + 3 * i) {
+            throw std::runtime_error("Sequential keys are not an arithmetic progression");
+        }
+    }
+
+    Workload::GenerateClusteredKeys(keys, count, clusterSize, min, max, seed);
+    for (size_t i = 0; i < count; ++i) {
+        const bool clusterStart = i % clusterSize == 0;
+        if (keys[i] < min || keys[i] > max ||
+            (clusterStart ? (keys[i] - min) % clusterSize != 0 : keys[i] != keys[i - 1] + 1)) {
+            throw std::runtime_error("Clustered keys are out of range or not in runs");
+        }
+    }
+    std::vector<Key> sortedKeys = keys;
+    std::sort(sortedKeys.begin(), sortedKeys.end());
+    if (std::adjacent_find(sortedKeys.begin(), sortedKeys.end()) != sortedKeys.end()) {
+        throw std::runtime_error("Clustered keys are not distinct");
+    }
+
+    constexpr size_t lookupsCount = 1 << 20;
+    constexpr double exponent = 1.;
+    Workload::GenerateSequentialKeys(keys, count, 0);
+    std::vector<Key> lookups;
+    Workload::GenerateZipfLookups(lookups, keys, lookupsCount, exponent, seed);
+    std::vector<size_t> hits(count);
+    for (Key key : lookups) {
+        ++hits[key];
+    }
+    // Ranks 0, 1 and 3 are hit often enough for a 10% tolerance
+    for (size_t rank : { 1, 3 }) {
+        const double ratio = static_cast<double>(hits[0]) / static_cast<double>(hits[rank]);
+        const double expected = std::pow(static_cast<double>(rank + 1), exponent);
+        if (std::abs(ratio / expected - 1.) > 0.1) {
+            throw std::runtime_error("Zipf lookups don't follow the distribution");
+        }
+    }
+}
 
 void Main() {
+    CheckWorkloads();
+    CheckShrinkToFit<LinearProbingCollisionPolicy>();
+    CheckShrinkToFit<QuadraticProbingCollisionPolicy>();
+    CheckShrinkToFit<RobinHoodCollisionPolicy>();
+
     const size_t valuesCount = std::numeric_limits<uint16_t>::max() + 1;
     const size_t stepsCount = 256;
     const size_t valuesPerStep = valuesCount / stepsCount;
@@ -146,44 +208,43 @@ void Main() {
         return static_cast<DurationU>(std::chrono::duration_cast<Duration>(t2 - t1).count());
     };
 
-    std::vector<std::vector<std::pair<DurationU, DurationU>>> addDurations(passesCount);
-    std::vector<std::vector<std::pair<DurationU, DurationU>>> findDurations(passesCount);
+    std::vector<std::vector<StepDurations>> addDurations(passesCount);
+    std::vector<std::vector<StepDurations>> findDurations(passesCount);
     for (size_t pass = 0; pass < passesCount; ++pass) {
         std::vector<std::pair<Key, Value>> pairs;
-        std::uniform_int_distribution<Key> keyDistribution(keyMinValues[pass], keyMaxValues[pass]);
         std::uniform_real_distribution<Value> valueDistribution(std::numeric_limits<float>::lowest(), std::numeric_limits<float>::max());
         pairs.reserve(valuesCount);
         {
-            // generate keys for the whole pass
-            for (size_t i = 0; i < valuesCount; ++i) {
-                // Make unique and random key
-                auto it = pairs.begin();
-                Key key;
-                do
-                {
-                    key = keyDistribution(gen);
-                    it = std::lower_bound(pairs.begin(), pairs.end(), key, [](auto& p1, Key key) {
-                        return p1.first < key;
-                    });
-                } while (it != pairs.end() && it->first == key);
-
-                auto value = valueDistribution(gen);
-                pairs.insert(it, std::pair{ key, value });
+            // unique keys of the pass range, already in random order
+            std::vector<Key> keys;
+            Workload::GenerateUniqueKeys(keys, valuesCount, keyMinValues[pass], keyMaxValues[pass], gen());
+            for (Key key : keys) {
+                pairs.emplace_back(key, valueDistribution(gen));
             }
-
-            // shuffle pairs
-            std::shuffle(pairs.begin(), pairs.end(), gen);
         }
 
         HashMap<LinearProbingCollisionPolicy> map_a(hasBytesCount);
         HashMap<QuadraticProbingCollisionPolicy> map_b(hasBytesCount);
+        SwissHashMap map_c(hasBytesCount);
+        HashMap<LinearProbingCollisionPolicy> map_d(hasBytesCount);
+        HashMap<RobinHoodCollisionPolicy> map_e(hasBytesCount);
+        CuckooMap map_f(hasBytesCount);
+        HashMap<LinearProbingCollisionPolicy, SplitLayout> map_g(hasBytesCount);
+        // Fixed capacity maps show probe lengths up to full occupancy. Quadratic probing regrows past half of it,
+        // so its steps above that are not measured (NaN, printed as "-")
+        map_a.SetMaxLoadFactor(1.f);
+        map_b.SetMaxLoadFactor(1.f);
+        map_e.SetMaxLoadFactor(1.f);
+        map_g.SetMaxLoadFactor(1.f);
         auto& passEmplaceDurations = addDurations[pass];
         auto& passFindDurations = findDurations[pass];
         for (size_t step = 0; step < stepsCount - 1; ++step) {
             const size_t pairsBegin = valuesPerStep * step;
-            const size_t minCapacity = std::min(map_a.GetCapacity(), map_b.GetCapacity());
+            const size_t minCapacity = std::min({ map_a.GetCapacity(), map_b.GetCapacity(), map_c.GetCapacity(), map_e.GetCapacity() });
             const size_t pairsEnd = std::min(pairsBegin + valuesPerStep, minCapacity);
             const size_t valuesOnStep = pairsEnd - pairsBegin;
+            const bool quadraticInCapacity = pairsEnd <= static_cast<size_t>(map_b.GetCapacity() * map_b.GetMaxLoadFactor());
+            const DurationU notMeasured = std::numeric_limits<DurationU>::quiet_NaN();
 
             auto validate_no_value = [](auto& map, size_t key) {
                 if constexpr (validateHashMap) {
@@ -226,8 +287,13 @@ void Main() {
                 };
 
                 auto duration_a = profileAdd(map_a) / valuesOnStep;
-                auto duration_b = profileAdd(map_b) / valuesOnStep;
-                passEmplaceDurations.push_back(std::pair{ duration_a, duration_b });
+                auto duration_b = quadraticInCapacity ? profileAdd(map_b) / valuesOnStep : notMeasured;
+                auto duration_c = profileAdd(map_c) / valuesOnStep;
+                auto duration_d = profileAdd(map_d) / valuesOnStep;
+                auto duration_e = profileAdd(map_e) / valuesOnStep;
+                auto duration_f = profileAdd(map_f) / valuesOnStep;
+                auto duration_g = profileAdd(map_g) / valuesOnStep;
+                passEmplaceDurations.push_back(StepDurations{ duration_a, duration_b, duration_c, duration_d, duration_e, duration_f, duration_g });
             }
 
             {
@@ -243,50 +309,1017 @@ void Main() {
                 };
 
                 auto duration_a = profileFind(map_a) / valuesOnStep;
-                auto duration_b = profileFind(map_b) / valuesOnStep;
-                passFindDurations.push_back(std::pair{ duration_a, duration_b });
+                auto duration_b = quadraticInCapacity ? profileFind(map_b) / valuesOnStep : notMeasured;
+                auto duration_c = profileFind(map_c) / valuesOnStep;
+                auto duration_d = profileFind(map_d) / valuesOnStep;
+                auto duration_e = profileFind(map_e) / valuesOnStep;
+                auto duration_f = profileFind(map_f) / valuesOnStep;
+                auto duration_g = profileFind(map_g) / valuesOnStep;
+                passFindDurations.push_back(StepDurations{ duration_a, duration_b, duration_c, duration_d, duration_e, duration_f, duration_g });
             }
         }
     }
 
-    auto showResults = [&](std::vector<std::vector<std::pair<DurationU, DurationU>>>& durations) {
+    auto showResults = [&](std::vector<std::vector<StepDurations>>& durations) {
         for (size_t step = 0; step < durations.front().size(); ++step) {
-            auto getMean = [&](DurationU std::pair<DurationU, DurationU>::*pMember) {
+            auto getMean = [&](size_t map) {
                 long double sum = 0;
                 for (size_t pass = 0; pass < passesCount; ++pass) {
-                    const auto& durationsPair = durations[pass][step];
-                    const DurationU duration = (durationsPair.*pMember);
+                    const DurationU duration = durations[pass][step][map];
                     sum += duration;
                 }
                 return (sum / passesCount);
             };
 
-            auto mean_a = getMean(&std::pair<DurationU, DurationU>::first);
-            auto mean_b = getMean(&std::pair<DurationU, DurationU>::second);
             float occupiedElementsPercent = static_cast<float>(valuesPerStep * step * 100) / valuesCount;
-            println(occupiedElementsPercent, split, mean_a, split, mean_b);
+            print(occupiedElementsPercent);
+            for (size_t map = 0; map < mapsCount; ++map) {
+                const auto mean = getMean(map);
+                if (std::isnan(mean)) {
+                    print(split, '-');
+                }
+                else {
+                    print(split, mean);
+                }
+            }
+            println();
         }
     };
 
     {
         println("Adding new elements to hash table");
-        println("Occupied elements percent", split, "Linear probing", split, "Quadratic probing");
+        println("Occupied elements percent", split, "Linear probing", split, "Quadratic probing", split, "Swiss table", split, "Linear probing (rehash at 0.75)", split, "Robin Hood", split, "Cuckoo (", CuckooMap::SlotsPerBucket, "-way buckets)", split, "Linear probing (split keys and values)");
         showResults(addDurations);
         println();
     }
 
     {
         println("Find existing elements");
-        println("Occupied elements percent", split, "Linear probing", split, "Quadratic probing");
+        println("Occupied elements percent", split, "Linear probing", split, "Quadratic probing", split, "Swiss table", split, "Linear probing (rehash at 0.75)", split, "Robin Hood", split, "Cuckoo (", CuckooMap::SlotsPerBucket, "-way buckets)", split, "Linear probing (split keys and values)");
         showResults(findDurations);
         println();
     }
+
+    {
+        println("Probe lengths of successful lookups (mean/max)");
+        println("Occupied elements percent", split, "Linear probing", split, "Quadratic probing", split, "Robin Hood");
+
+        std::vector<Key> keys;
+        Workload::GenerateUniqueKeys(keys, valuesCount, Key{ 0 }, std::numeric_limits<Key>::max(), gen());
+
+        // Quadratic probing regrows past half occupancy: its rows above that are "-"
+        auto probeLengths = [&](auto map, size_t percent) {
+            map.SetMaxLoadFactor(1.f);
+            if (percent > map.GetMaxLoadFactor() * 100) {
+                print(split, '-');
+                return;
+            }
+            const size_t count = std::min(map.GetCapacity() * percent / 100, keys.size());
+            for (size_t i = 0; i < count; ++i) {
+                map.Emplace(keys[i], Value{});
+            }
+            const ProbeStatistics statistics = map.GetProbeStatistics();
+            print(split, statistics.meanLength, '/', statistics.maxLength);
+        };
+
+        for (size_t percent : { 50, 60, 70, 80, 90, 95 }) {
+            print(percent);
+            probeLengths(HashMap<LinearProbingCollisionPolicy>(hasBytesCount), percent);
+            probeLengths(HashMap<QuadraticProbingCollisionPolicy>(hasBytesCount), percent);
+            probeLengths(HashMap<RobinHoodCollisionPolicy>(hasBytesCount), percent);
+            println();
+        }
+        println();
+    }
+
+#if HASH_MAP_STATISTICS
+    {
+        // Recorded by the maps themselves: probe lengths of every operation at fixed occupancies,
+        // clusters of the probing tables, bucket sizes of the bucket table and resizes of a growing table
+        using BucketsMap = OpenHashMap<Key, Value, KnuthMultiplicativeMethod<Key>>;
+        constexpr HashMapOperation operations[]{ HashMapOperation::Emplace, HashMapOperation::Find, HashMapOperation::FindMissing };
+        constexpr const char* operationNames[]{ "emplace", "find", "find missing" };
+        constexpr const char* mapNames[]{ "Linear probing", "Quadratic probing", "Robin Hood", "Buckets" };
+
+        std::vector<Key> keys;
+        Workload::GenerateUniqueKeys(keys, valuesCount, Key{ 0 }, std::numeric_limits<Key>::max(), gen());
+
+        for (size_t percent : { 50, 70, 90 }) {
+            HashMap<LinearProbingCollisionPolicy> map_a(hasBytesCount);
+            HashMap<QuadraticProbingCollisionPolicy> map_b(hasBytesCount);
+            HashMap<RobinHoodCollisionPolicy> map_e(hasBytesCount);
+            BucketsMap map_h(maxBucketsCount);
+            map_a.SetMaxLoadFactor(1.f);
+            map_b.SetMaxLoadFactor(1.f);
+            map_e.SetMaxLoadFactor(1.f);
+
+            // Stored keys are looked up once each, missing ones are the rest of the keys
+            const size_t count = maxBucketsCount * percent / 100;
+            auto run = [&](auto& map) {
+                for (size_t i = 0; i < count; ++i) {
+                    map.Emplace(keys[i], Value{});
+                }
+                for (size_t i = 0; i < count; ++i) {
+                    [[maybe_unused]] const volatile auto pValue = map.Find(keys[i]);
+                }
+                for (size_t i = 0; i < count; ++i) {
+                    [[maybe_unused]] const volatile auto pValue = map.Find(keys[count + i % (keys.size() - count)]);
+                }
+                return &map.GetStatistics();
+            };
+
+            // Quadratic probing regrows past half occupancy: its columns above that are "-"
+            const bool quadraticInCapacity = percent <= map_b.GetMaxLoadFactor() * 100;
+            const HashMapStatistics* statistics[]{ run(map_a), quadraticInCapacity ? run(map_b) : nullptr, run(map_e), run(map_h) };
+            size_t maxLength = 0;
+            for (const HashMapStatistics* mapStatistics : statistics) {
+                if (mapStatistics == nullptr) {
+                    continue;
+                }
+                for (HashMapOperation operation : operations) {
+                    maxLength = std::max(maxLength, mapStatistics->GetProbes(operation).GetMaxLength());
+                }
+            }
+
+            println("Probe lengths at ", percent, "% occupancy: operations count (buckets map: size of the searched bucket)");
+            print("Probe length");
+            for (const char* mapName : mapNames) {
+                for (const char* operationName : operationNames) {
+                    print(split, mapName, ' ', operationName);
+                }
+            }
+            println();
+
+            auto printRow = [&](auto&& name, auto&& getValue) {
+                print(name);
+                for (const HashMapStatistics* mapStatistics : statistics) {
+                    for (HashMapOperation operation : operations) {
+                        if (mapStatistics == nullptr) {
+                            print(split, '-');
+                        }
+                        else {
+                            print(split, getValue(mapStatistics->GetProbes(operation)));
+                        }
+                    }
+                }
+                println();
+            };
+
+            for (size_t length = 0; length <= std::min(maxLength, LengthHistogram::MaxExactLength); ++length) {
+                const bool last = length == LengthHistogram::MaxExactLength;
+                printRow(last ? std::to_string(length) + '+' : std::to_string(length), [&](const LengthHistogram& histogram) {
+                    return histogram.GetCount(length);
+                });
+            }
+            printRow("Mean", [](const LengthHistogram& histogram) {
+                return histogram.GetMean();
+            });
+            printRow("Max", [](const LengthHistogram& histogram) {
+                return histogram.GetMaxLength();
+            });
+            print("Max cluster length", split, map_a.GetMaxClusterLength(), split);
+            if (quadraticInCapacity) {
+                print(map_b.GetMaxClusterLength());
+            }
+            else {
+                print('-');
+            }
+            println(split, map_e.GetMaxClusterLength());
+            println();
+
+            println("Bucket sizes at ", percent, "% occupancy");
+            println("Bucket size", split, "Buckets count");
+            const LengthHistogram bucketSizes = map_h.GetBucketSizeHistogram();
+            for (size_t size = 0; size <= std::min(bucketSizes.GetMaxLength(), LengthHistogram::MaxExactLength); ++size) {
+                println(size, split, bucketSizes.GetCount(size));
+            }
+            println();
+        }
+
+        {
+            // Growth from the smallest table, then erases and emplaces at constant size drop tombstones in place
+            HashMap<LinearProbingCollisionPolicy> map(0);
+            const size_t half = keys.size() / 2;
+            for (size_t i = 0; i < half; ++i) {
+                map.Emplace(keys[i], Value{});
+            }
+            for (size_t i = 0; i < half; ++i) {
+                map.Erase(keys[i]);
+                map.Emplace(keys[half + i], Value{});
+            }
+
+            println("Resizes of linear probing (rehash at 0.75)");
+            println("Size", split, "Old capacity", split, "New capacity", split, "In place");
+            for (const ResizeEvent& event : map.GetStatistics().GetResizes()) {
+                println(event.size, split, event.oldCapacity, split, event.newCapacity, split, event.inPlace);
+            }
+            println();
+        }
+    }
+#endif
+
+    {
+        // Interleaved slots of a cache line value fill a line per probe, split layout probes 16 byte key slots
+        struct LargeValue
+        {
+            Value values[64 / sizeof(Value)];
+        };
+
+        using LargeValueMap = ClosedHashMap<Key, LargeValue, KnuthMultiplicativeMethod<Key>, LinearProbingCollisionPolicy, InterleavedLayout>;
+        using LargeValueSplitMap = ClosedHashMap<Key, LargeValue, KnuthMultiplicativeMethod<Key>, LinearProbingCollisionPolicy, SplitLayout>;
+        constexpr size_t lookupsCount = valuesCount;
+
+        std::vector<Key> keys;
+        Workload::GenerateUniqueKeys(keys, valuesCount, Key{ 0 }, std::numeric_limits<Key>::max(), gen());
+
+        LargeValueMap map_interleaved(hasBytesCount);
+        LargeValueSplitMap map_split(hasBytesCount);
+        map_interleaved.SetMaxLoadFactor(1.f);
+        map_split.SetMaxLoadFactor(1.f);
+
+        auto profileLookups = [&](auto& map, size_t count) {
+            std::vector<Key> lookups(lookupsCount);
+            std::uniform_int_distribution<size_t> indexDistribution(0, count - 1);
+            std::generate(lookups.begin(), lookups.end(), [&]() {
+                return keys[indexDistribution(gen)];
+            });
+
+            return getExecutionTime([&]() {
+                for (Key key : lookups) {
+                    const volatile auto pValue = map.Find(key);
+                    if constexpr (validateHashMap) {
+                        if (!pValue || pValue->values[0] != static_cast<Value>(key)) {
+                            throw std::runtime_error("Element not in collection bug it must be there");
+                        }
+                    }
+                }
+            }) / lookupsCount;
+        };
+
+        println("Find existing elements with 64 byte values: nanoseconds per lookup");
+        println("Occupied elements percent", split, "Linear probing", split, "Linear probing (split keys and values)");
+        size_t count = 0;
+        for (size_t percent : { 10, 20, 30, 40, 50, 60, 70, 80, 90, 95 }) {
+            for (; count < std::min(map_split.GetCapacity() * percent / 100, keys.size()); ++count) {
+                const LargeValue value{ { static_cast<Value>(keys[count]) } };
+                map_interleaved.Emplace(keys[count], value);
+                map_split.Emplace(keys[count], value);
+            }
+
+            println(percent, split, profileLookups(map_interleaved, count), split, profileLookups(map_split, count));
+        }
+        println();
+    }
+
+    {
+        // Steady state: every round erases random elements and inserts as many new ones.
+        // Tombstones lengthen probes of linear and quadratic probing until erase drops them all
+        constexpr size_t roundsCount = 48;
+        constexpr size_t churnPerRound = valuesCount / 32;
+        constexpr size_t lookupsCount = valuesCount;
+        const size_t occupiedCount = valuesCount / 2;
+
+        std::uniform_int_distribution<Key> keyDistribution;
+        std::vector<Key> liveKeys;
+        HashMap<LinearProbingCollisionPolicy> map_linear(hasBytesCount);
+        HashMap<QuadraticProbingCollisionPolicy> map_quadratic(hasBytesCount);
+        HashMap<RobinHoodCollisionPolicy> map_robinHood(hasBytesCount);
+
+        auto insertNew = [&]() {
+            Key key;
+            do {
+                key = keyDistribution(gen);
+            } while (map_linear.Find(key) != nullptr);
+            liveKeys.push_back(key);
+            map_linear.Emplace(key, static_cast<Value>(key));
+            map_quadratic.Emplace(key, static_cast<Value>(key));
+            map_robinHood.Emplace(key, static_cast<Value>(key));
+        };
+
+        auto eraseRandom = [&]() {
+            const size_t index = std::uniform_int_distribution<size_t>(0, liveKeys.size() - 1)(gen);
+            const Key key = liveKeys[index];
+            liveKeys[index] = liveKeys.back();
+            liveKeys.pop_back();
+            const bool erased = map_linear.Erase(key) && map_quadratic.Erase(key) && map_robinHood.Erase(key);
+            if constexpr (validateHashMap) {
+                if (!erased || map_linear.Find(key) != nullptr) {
+                    throw std::runtime_error("Erased element is in collection");
+                }
+            }
+        };
+
+        auto profileLookups = [&](auto& map) {
+            std::vector<Key> lookups(lookupsCount);
+            std::uniform_int_distribution<size_t> indexDistribution(0, liveKeys.size() - 1);
+            std::generate(lookups.begin(), lookups.end(), [&]() {
+                return liveKeys[indexDistribution(gen)];
+            });
+
+            return getExecutionTime([&]() {
+                for (Key key : lookups) {
+                    const volatile auto pValue = map.Find(key);
+                    if constexpr (validateHashMap) {
+                        if (!pValue || *pValue != static_cast<Value>(key)) {
+                            throw std::runtime_error("Element not in collection bug it must be there");
+                        }
+                    }
+                }
+            }) / lookupsCount;
+        };
+
+        auto tombstonesPercent = [](auto& map) {
+            return static_cast<float>(map.GetTombstonesCount() * 100) / map.GetCapacity();
+        };
+
+        for (size_t i = 0; i < occupiedCount; ++i) {
+            insertNew();
+        }
+
+        println("Churn at fixed occupancy: nanoseconds per lookup after each round of ", churnPerRound, " erases and insertions");
+        println("Round", split, "Linear probing", split, "Linear probing tombstones percent", split,
+            "Quadratic probing", split, "Quadratic probing tombstones percent", split, "Robin Hood");
+        for (size_t round = 0; round <= roundsCount; ++round) {
+            if (round != 0) {
+                for (size_t i = 0; i < churnPerRound; ++i) {
+                    eraseRandom();
+                    insertNew();
+                }
+            }
+
+            println(round,
+                split, profileLookups(map_linear), split, tombstonesPercent(map_linear),
+                split, profileLookups(map_quadratic), split, tombstonesPercent(map_quadratic),
+                split, profileLookups(map_robinHood));
+        }
+        println();
+    }
+
+    {
+        // From tables fitting in caches to tables many times larger than the last level cache
+        constexpr size_t lookupsCount = size_t{ 1 } << 20;
+        constexpr size_t elementsCounts[]{ size_t{ 1 } << 16, size_t{ 1 } << 20, size_t{ 1 } << 22, size_t{ 1 } << 24 };
+
+        println("Find existing elements in large tables: nanoseconds per lookup");
+        println("Elements count", split, "Linear probing (rehash at 0.75)", split, "Linear probing (rehash at 0.75), batched");
+        for (size_t elementsCount : elementsCounts) {
+            std::vector<Key> keys;
+            Workload::GenerateUniqueKeys(keys, elementsCount, Key{ 0 }, std::numeric_limits<Key>::max(), gen());
+            HashMap<LinearProbingCollisionPolicy> map(hasBytesCount);
+            map.Reserve(elementsCount);
+            for (Key key : keys) {
+                map.Emplace(key, static_cast<Value>(key));
+            }
+
+            std::vector<Key> lookups;
+            Workload::GenerateUniformLookups(lookups, keys, lookupsCount, gen());
+            std::vector<Value*> values(lookupsCount);
+
+            auto validate_values = [&]() {
+                if constexpr (validateHashMap) {
+                    for (size_t i = 0; i < lookupsCount; ++i) {
+                        if (values[i] == nullptr || *values[i] != static_cast<Value>(lookups[i])) {
+                            throw std::runtime_error("Element not in collection bug it must be there");
+                        }
+                    }
+                }
+            };
+
+            const DurationU scalarDuration = getExecutionTime([&]() {
+                for (size_t i = 0; i < lookupsCount; ++i) {
+                    values[i] = map.Find(lookups[i]);
+                }
+            });
+            validate_values();
+
+            std::fill(values.begin(), values.end(), nullptr);
+            const DurationU batchedDuration = getExecutionTime([&]() {
+                map.FindBatch(lookups.data(), lookupsCount, values.data());
+            });
+            validate_values();
+
+            println(elementsCount, split, scalarDuration / lookupsCount, split, batchedDuration / lookupsCount);
+        }
+        println();
+    }
+
+    {
+        // Skewed lookups keep popular keys in caches; sequential and clustered keys test the hasher's mixing
+        constexpr size_t elementsCount = size_t{ 1 } << 22;
+        constexpr size_t lookupsCount = size_t{ 1 } << 20;
+        constexpr size_t clusterSize = 64;
+        constexpr double zipfExponents[]{ 0.99, 1.2 };
+
+        println("Find existing elements by key distribution: nanoseconds per lookup, ", elementsCount, " elements");
+        print("Keys", split, "Uniform lookups");
+        for (double exponent : zipfExponents) {
+            print(split, "Zipf ", exponent, " lookups");
+        }
+        println();
+
+        const std::pair<const char*, std::function<void(std::vector<Key>&)>> keySets[]{
+            { "Random", [&](std::vector<Key>& keys) { Workload::GenerateUniqueKeys(keys, elementsCount, Key{ 0 }, std::numeric_limits<Key>::max(), gen()); } },
+            { "Sequential", [&](std::vector<Key>& keys) { Workload::GenerateSequentialKeys(keys, elementsCount, Key{ 0 }); } },
+            { "Clustered by 64", [&](std::vector<Key>& keys) { Workload::GenerateClusteredKeys(keys, elementsCount, clusterSize, Key{ 0 }, std::numeric_limits<Key>::max(), gen()); } },
+        };
+
+        for (const auto& [name, generateKeys] : keySets) {
+            std::vector<Key> keys;
+            generateKeys(keys);
+            HashMap<LinearProbingCollisionPolicy> map(hasBytesCount);
+            map.Reserve(elementsCount);
+            for (Key key : keys) {
+                map.Emplace(key, static_cast<Value>(key));
+            }
+
+            std::vector<Key> lookups;
+            auto profileLookups = [&]() {
+                Value sum = 0;
+                const DurationU duration = getExecutionTime([&]() {
+                    for (Key key : lookups) {
+                        sum += *map.Find(key);
+                    }
+                });
+                [[maybe_unused]] const volatile Value result = sum;
+                return duration / lookupsCount;
+            };
+
+            Workload::GenerateUniformLookups(lookups, keys, lookupsCount, gen());
+            print(name, split, profileLookups());
+            for (double exponent : zipfExponents) {
+                Workload::GenerateZipfLookups(lookups, keys, lookupsCount, exponent, gen());
+                print(split, profileLookups());
+            }
+            println();
+        }
+        println();
+    }
 }
 
-int main(int, char**) {
+// Throughput of the sharded map against one ClosedHashMap behind a mutex,
+// for several shares of lookups among operations and threads counts
+void ConcurrentMain() {
+    constexpr size_t prefilledCount = 1 << 16;
+    constexpr size_t operationsCount = 1 << 21;
+    constexpr const char split = ';';
+    constexpr size_t threadsCounts[]{ 1, 2, 4, 8, 16, 32, 64 };
+    constexpr size_t readPercents[]{ 50, 90, 99 };
+
+    std::mt19937_64 gen(std::random_device{}());
+    std::vector<Key> prefilledKeys(prefilledCount);
+    for (Key& key : prefilledKeys) {
+        // Inserted keys have the highest bit set, prefilled ones don't
+        key = gen() >> 1;
+    }
+
+    auto print = [](auto... values) {
+        (std::cout << ... << values);
+    };
+
+    auto println = [&print](auto... values) {
+        print(values..., '\n');
+    };
+
+    // Runs 'threadsCount' workers of the pool at once, each one calls 'work(threadIndex)'.
+    // Returns millions of operations per second
+    auto measure = [&](size_t threadsCount, auto&& work) {
+        ThreadPool<void> pool;
+        pool.SetDesiredThreadsCount(threadsCount);
+
+        std::atomic<size_t> ready = 0;
+        std::atomic<bool> go = false;
+        std::vector<Clock::time_point> finish(threadsCount);
+        for (size_t thread = 0; thread < threadsCount; ++thread) {
+            pool.AddTask([&, thread]() {
+                ++ready;
+                while (!go.load()) {
+                    std::this_thread::yield();
+                }
+                work(thread);
+                finish[thread] = Clock::now();
+            });
+        }
+
+        // Workers start together, so pool startup is not measured
+        pool.Start();
+        while (ready.load() != threadsCount) {
+            std::this_thread::yield();
+        }
+        const auto start = Clock::now();
+        go = true;
+        pool.StopAndWait();
+
+        const auto end = *std::max_element(finish.begin(), finish.end());
+        const double seconds = std::chrono::duration<double>(end - start).count();
+        return static_cast<double>(operationsCount) / seconds / 1e6;
+    };
+
+    // Every thread makes its share of operations: lookups of prefilled keys and insertions of new ones.
+    // Prefilled keys are never removed, so every lookup must succeed
+    std::atomic<size_t> misses = 0;
+    auto runOperations = [&](size_t thread, size_t threadsCount, size_t readPercent, auto&& find, auto&& insert) {
+        std::mt19937_64 threadGen(thread);
+        const size_t count = operationsCount / threadsCount;
+        size_t threadMisses = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (threadGen() % 100 < readPercent) {
+                threadMisses += find(prefilledKeys[threadGen() % prefilledCount]) ? 0 : 1;
+            }
+            else {
+                insert((Key{ 1 } << 63) | (Key{ thread } << 40) | i);
+            }
+        }
+        misses += threadMisses;
+    };
+
+    println("Concurrent access: millions of operations per second");
+    print("Threads");
+    for (size_t readPercent : readPercents) {
+        print(split, "Sharded, ", readPercent, "% reads", split, "Mutex, ", readPercent, "% reads");
+    }
+    println();
+
+    for (size_t threadsCount : threadsCounts) {
+        print(threadsCount);
+        for (size_t readPercent : readPercents) {
+            {
+                ConcurrentHashMap<Key, Value, KnuthMultiplicativeMethod<Key>> map(prefilledCount + operationsCount);
+                for (Key key : prefilledKeys) {
+                    map.Insert(key, Value{});
+                }
+
+                print(split, measure(threadsCount, [&](size_t thread) {
+                    runOperations(thread, threadsCount, readPercent,
+                        [&](Key key) { return map.Find(key).has_value(); },
+                        [&](Key key) { map.Insert(key, Value{}); });
+                }));
+            }
+
+            {
+                std::mutex mutex;
+                HashMap<LinearProbingCollisionPolicy> map(0);
+                map.Reserve(prefilledCount + operationsCount);
+                for (Key key : prefilledKeys) {
+                    if (map.Find(key) == nullptr) {
+                        map.Emplace(key, Value{});
+                    }
+                }
+
+                print(split, measure(threadsCount, [&](size_t thread) {
+                    runOperations(thread, threadsCount, readPercent,
+                        [&](Key key) {
+                            std::lock_guard<std::mutex> guard(mutex);
+                            return map.Find(key) != nullptr;
+                        },
+                        [&](Key key) {
+                            std::lock_guard<std::mutex> guard(mutex);
+                            map.Emplace(key, Value{});
+                        });
+                }));
+            }
+        }
+        println();
+    }
+
+    if (misses != 0) {
+        throw std::runtime_error("Prefilled keys are not found");
+    }
+}
+
+// Quality of the hashers' own output on 64 bit keys, before any mixing done by the maps
+void HashQualityMain() {
+    constexpr const char split = ';';
+    constexpr const char* hasherNames[]{ "Knuth", "First n bits", "Fibonacci", "wyhash", "CRC32C" };
+    // Output width of each hasher
+    constexpr size_t hashBits[]{ 64, 64, 64, 64, 32 };
+    const std::tuple hashers{
+        KnuthMultiplicativeMethod<Key>{},
+        FirstNBitsHasher<Key>{},
+        FibonacciHasher<Key>{},
+        WyHasher<Key>{},
+        Crc32cHasher<Key>{}
+    };
+
+    std::mt19937_64 gen(std::random_device{}());
+
+    auto print = [](auto... values) {
+        (std::cout << ... << values);
+    };
+
+    auto println = [&print](auto... values) {
+        print(values..., '\n');
+    };
+
+    // Calls 'fn(hasher, index)' for every hasher
+    auto forEachHasher = [&](auto&& fn) {
+        std::apply([&](const auto&... hasher) {
+            size_t index = 0;
+            (fn(hasher, index++), ...);
+        }, hashers);
+    };
+
+    auto printHeader = [&](const char* first) {
+        print(first);
+        for (const char* name : hasherNames) {
+            print(split, name);
+        }
+    };
+
+    {
+        // Flipping one key bit must flip every hash bit with probability 1/2.
+        // Bias of a pair of bits is 2 * |probability - 1/2|: 0 is ideal, 1 means the bit never or always flips
+        constexpr size_t keysCount = 1 << 12;
+        constexpr size_t keyBits = 64;
+        std::vector<DurationU> meanBiases;
+        std::vector<DurationU> maxBiases;
+        forEachHasher([&](const auto& hasher, size_t index) {
+            std::vector<size_t> flips(keyBits * hashBits[index]);
+            for (size_t i = 0; i < keysCount; ++i) {
+                const Key key = gen();
+                const size_t hash = hasher(key);
+                for (size_t keyBit = 0; keyBit < keyBits; ++keyBit) {
+                    const size_t difference = hash ^ hasher(key ^ (Key{ 1 } << keyBit));
+                    for (size_t hashBit = 0; hashBit < hashBits[index]; ++hashBit) {
+                        flips[keyBit * hashBits[index] + hashBit] += (difference >> hashBit) & 1;
+                    }
+                }
+            }
+
+            DurationU sum = 0;
+            DurationU max = 0;
+            for (size_t count : flips) {
+                const DurationU bias = std::abs(2 * static_cast<DurationU>(count) / keysCount - 1);
+                sum += bias;
+                max = std::max(max, bias);
+            }
+            meanBiases.push_back(sum / flips.size());
+            maxBiases.push_back(max);
+        });
+
+        println("Avalanche: bias of hash bits on single key bit flips");
+        printHeader("Bias");
+        println();
+        print("Mean");
+        for (DurationU bias : meanBiases) {
+            print(split, bias);
+        }
+        println();
+        print("Max");
+        for (DurationU bias : maxBiases) {
+            print(split, bias);
+        }
+        println('\n');
+    }
+
+    {
+        // Keys go to 2^16 buckets by 16 bit hashes, as maps indexing by 'bytes' wide hashes do.
+        // Rate is the share of keys which land in an occupied bucket
+        constexpr size_t hashBytes = 2;
+        constexpr size_t bucketsCount = size_t{ 1 } << (hashBytes * 8);
+        constexpr size_t keysCount = bucketsCount;
+        constexpr size_t keyAbsoluteValue = std::numeric_limits<Key>::max();
+
+        auto randomKey = [&](Key min, Key max) {
+            return std::uniform_int_distribution<Key>(min, max)(gen);
+        };
+
+        const std::pair<const char*, std::function<Key(size_t)>> keySets[]{
+            { "Random", [&](size_t) { return randomKey(0, keyAbsoluteValue); } },
+            { "Random below max / 10^10", [&](size_t) { return randomKey(0, keyAbsoluteValue / 10000000000); } },
+            { "Random above max / 10", [&](size_t) { return randomKey(keyAbsoluteValue / 10, keyAbsoluteValue); } },
+            { "Sequential", [](size_t i) { return Key{ i }; } },
+            { "Stride 2^16", [](size_t i) { return Key{ i } << 16; } },
+            { "Stride 2^32", [](size_t i) { return Key{ i } << 32; } },
+        };
+
+        // Expected for a random function: keys minus expected count of occupied buckets
+        const DurationU occupied = bucketsCount * (1 - std::pow(1 - DurationU{ 1 } / bucketsCount, DurationU{ keysCount }));
+        const DurationU expectedRate = 1 - occupied / keysCount;
+
+        println("Collision rate: ", keysCount, " keys in ", bucketsCount, " buckets, random function gives ", expectedRate);
+        printHeader("Keys");
+        println();
+        std::vector<Key> keys(keysCount);
+        std::vector<bool> bucketOccupied(bucketsCount);
+        for (const auto& [name, makeKey] : keySets) {
+            for (size_t i = 0; i < keysCount; ++i) {
+                keys[i] = makeKey(i);
+            }
+
+            print(name);
+            forEachHasher([&](const auto& hasher, size_t) {
+                std::fill(bucketOccupied.begin(), bucketOccupied.end(), false);
+                size_t collisions = 0;
+                for (Key key : keys) {
+                    const size_t bucket = hasher(key, hashBytes) % bucketsCount;
+                    collisions += bucketOccupied[bucket] ? 1 : 0;
+                    bucketOccupied[bucket] = true;
+                }
+                print(split, static_cast<DurationU>(collisions) / keysCount);
+            });
+            println();
+        }
+        println();
+    }
+
+    auto getExecutionTime = [](auto&& fn) {
+        auto t1 = Clock::now();
+        fn();
+        auto t2 = Clock::now();
+        return static_cast<DurationU>(std::chrono::duration_cast<Duration>(t2 - t1).count());
+    };
+
+    {
+        constexpr size_t keysCount = 1 << 22;
+        std::vector<Key> keys(keysCount);
+        for (Key& key : keys) {
+            key = gen();
+        }
+
+        println("Throughput: nanoseconds per 64 bit key");
+        printHeader("Hasher");
+        println();
+        print("Full width hash");
+        forEachHasher([&](const auto& hasher, size_t) {
+            size_t sum = 0;
+            const DurationU duration = getExecutionTime([&]() {
+                for (Key key : keys) {
+                    sum += hasher(key);
+                }
+            });
+            [[maybe_unused]] const volatile size_t result = sum;
+            print(split, duration / keysCount);
+        });
+        println('\n');
+    }
+
+    {
+        constexpr size_t sizes[]{ 16, 64, 256, 4096, 65536 };
+        constexpr size_t bytesPerSize = size_t{ 1 } << 26;
+        std::vector<uint8_t> bytes(sizes[std::size(sizes) - 1]);
+        for (uint8_t& byte : bytes) {
+            byte = static_cast<uint8_t>(gen());
+        }
+
+        const std::pair<const char*, std::function<uint64_t(const uint8_t*, size_t)>> byteHashers[]{
+            { "wyhash", [](const uint8_t* data, size_t size) { return Hashing::WyHash(data, size); } },
+            { "CRC32C (SSE4.2)", [](const uint8_t* data, size_t size) { return Hashing::Crc32c(data, size, 0, true); } },
+            { "CRC32C (table)", [](const uint8_t* data, size_t size) { return Hashing::Crc32c(data, size, 0, false); } },
+        };
+
+        println("Throughput: GB/s of byte strings");
+        print("Size");
+        for (const auto& [name, hashBytes] : byteHashers) {
+            print(split, name);
+        }
+        println();
+
+        for (size_t size : sizes) {
+            print(size);
+            for (const auto& [name, hashBytes] : byteHashers) {
+                if (std::string_view(name) == "CRC32C (SSE4.2)" && !Hashing::HasCrc32cInstruction()) {
+                    print(split, "-");
+                    continue;
+                }
+
+                uint64_t sum = 0;
+                const DurationU duration = getExecutionTime([&]() {
+                    for (size_t done = 0; done < bytesPerSize; done += size) {
+                        sum += hashBytes(bytes.data(), size);
+                    }
+                });
+                [[maybe_unused]] const volatile uint64_t result = sum;
+                print(split, static_cast<DurationU>(bytesPerSize) / duration);
+            }
+            println();
+        }
+    }
+}
+
+// Startup of a table stored in a file: building it in memory against mapping the written file
+void MappedMain() {
+    using MappedMap = MappedHashMap<Key, Value, WyHasher<Key>>;
+    constexpr const char split = ';';
+    constexpr size_t elementsCounts[]{ size_t{ 1 } << 20, size_t{ 1 } << 22, size_t{ 1 } << 24, size_t{ 1 } << 25 };
+    constexpr size_t firstLookupsCount = 1000;
+    const std::string path = (std::filesystem::temp_directory_path() / "aads_006_001.map").string();
+
+    std::mt19937_64 gen(std::random_device{}());
+
+    auto println = [](auto... values) {
+        (std::cout << ... << values) << '\n';
+    };
+
+    auto getMilliseconds = [](auto&& fn) {
+        auto t1 = Clock::now();
+        fn();
+        auto t2 = Clock::now();
+        return std::chrono::duration<double, std::milli>(t2 - t1).count();
+    };
+
+    println("Table startup: milliseconds");
+    println("Elements count", split, "File MB", split, "Build in memory", split, "Write file", split, "Open mapped file",
+        split, firstLookupsCount, " first lookups", split, "Verify checksum");
+    for (size_t elementsCount : elementsCounts) {
+        std::vector<Key> keys;
+        Workload::GenerateUniqueKeys(keys, elementsCount, Key{ 0 }, std::numeric_limits<Key>::max(), gen());
+        std::vector<std::pair<Key, Value>> elements(elementsCount);
+        for (size_t i = 0; i < elementsCount; ++i) {
+            elements[i] = { keys[i], static_cast<Value>(keys[i]) };
+        }
+
+        const double buildDuration = getMilliseconds([&]() {
+            HashMap<LinearProbingCollisionPolicy> map(0);
+            map.Reserve(elementsCount);
+            for (const auto& [key, value] : elements) {
+                map.Emplace(key, value);
+            }
+        });
+
+        const double writeDuration = getMilliseconds([&]() {
+            MappedMap::Write(path, elements.data(), elements.size());
+        });
+
+        std::optional<MappedMap> map;
+        const double openDuration = getMilliseconds([&]() {
+            map.emplace(path);
+        });
+
+        std::uniform_int_distribution<size_t> indexDistribution(0, elementsCount - 1);
+        const double lookupsDuration = getMilliseconds([&]() {
+            for (size_t i = 0; i < firstLookupsCount; ++i) {
+                const auto& [key, value] = elements[indexDistribution(gen)];
+                const Value* pValue = map->Find(key);
+                if (!pValue || *pValue != value) {
+                    throw std::runtime_error("Element not in mapped table bug it must be there");
+                }
+            }
+        });
+
+        bool checksumMatches = false;
+        const double verifyDuration = getMilliseconds([&]() {
+            checksumMatches = map->VerifyChecksum();
+        });
+        if (!checksumMatches) {
+            throw std::runtime_error("Checksum of written table does not match");
+        }
+
+        const double fileMegabytes = static_cast<double>(std::filesystem::file_size(path)) / (1 << 20);
+        map.reset();
+        std::filesystem::remove(path);
+        println(elementsCount, split, fileMegabytes, split, buildDuration, split, writeDuration, split, openDuration,
+            split, lookupsDuration, split, verifyDuration);
+    }
+}
+
+// Tables over a fixed key set: minimal perfect hashing against probing and bucket tables on the same keys
+void PerfectMain() {
+    using PerfectMap = PerfectHashMap<Key, Value, WyHasher<Key>>;
+    using BucketsMap = OpenHashMap<Key, Value, KnuthMultiplicativeMethod<Key>>;
+    constexpr const char split = ';';
+    constexpr size_t elementsCounts[]{ size_t{ 1 } << 16, size_t{ 1 } << 20, size_t{ 1 } << 23 };
+    constexpr size_t lookupsCount = size_t{ 1 } << 22;
+    const size_t threadsCount = std::max(1u, std::thread::hardware_concurrency());
+
+    std::mt19937_64 gen(std::random_device{}());
+
+    auto println = [](auto... values) {
+        (std::cout << ... << values) << '\n';
+    };
+
+    auto getMilliseconds = [](auto&& fn) {
+        auto t1 = Clock::now();
+        fn();
+        auto t2 = Clock::now();
+        return std::chrono::duration<double, std::milli>(t2 - t1).count();
+    };
+
+    auto getBatchedLookupNanoseconds = [&](const std::vector<Key>& keys, const auto& map) {
+        std::vector<const Value*> values(keys.size());
+        auto t1 = Clock::now();
+        map.FindBatch(keys.data(), keys.size(), values.data());
+        auto t2 = Clock::now();
+        const size_t found = keys.size() - std::count(values.begin(), values.end(), nullptr);
+        return std::pair{ std::chrono::duration<double, std::nano>(t2 - t1).count() / keys.size(), found };
+    };
+
+    auto getLookupNanoseconds = [&](const std::vector<Key>& keys, auto&& find) {
+        size_t found = 0;
+        auto t1 = Clock::now();
+        for (Key key : keys) {
+            found += find(key) != nullptr;
+        }
+        auto t2 = Clock::now();
+        return std::pair{ std::chrono::duration<double, std::nano>(t2 - t1).count() / keys.size(), found };
+    };
+
+    println("Static key sets: build milliseconds, nanoseconds per lookup; perfect map built on 1 and ", threadsCount, " threads");
+    println("Elements count", split, "Perfect map bits per key",
+        split, "Build perfect (1 thread)", split, "Build perfect", split, "Build linear probing", split, "Build Robin Hood", split, "Build buckets",
+        split, "Find perfect", split, "Find perfect (batched)", split, "Find linear probing", split, "Find Robin Hood", split, "Find buckets",
+        split, "Miss perfect", split, "Miss linear probing", split, "Miss Robin Hood", split, "Miss buckets");
+    for (size_t elementsCount : elementsCounts) {
+        // The first half of unique keys is stored, the second one is looked up as missing
+        std::vector<Key> keys;
+        Workload::GenerateUniqueKeys(keys, 2 * elementsCount, Key{ 0 }, std::numeric_limits<Key>::max(), gen());
+        const std::vector<Key> missingKeys(keys.begin() + elementsCount, keys.end());
+        keys.resize(elementsCount);
+
+        std::vector<std::pair<Key, Value>> elements(elementsCount);
+        for (size_t i = 0; i < elementsCount; ++i) {
+            elements[i] = { keys[i], static_cast<Value>(keys[i]) };
+        }
+
+        std::vector<Key> hitKeys;
+        std::vector<Key> missKeys;
+        Workload::GenerateUniformLookups(hitKeys, keys, lookupsCount, gen());
+        Workload::GenerateUniformLookups(missKeys, missingKeys, lookupsCount, gen());
+
+        const double perfectSingleThreadDuration = getMilliseconds([&]() {
+            PerfectMap map(elements.data(), elements.size(), 1);
+        });
+
+        std::optional<PerfectMap> perfectMap;
+        const double perfectDuration = getMilliseconds([&]() {
+            perfectMap.emplace(elements.data(), elements.size(), threadsCount);
+        });
+
+        HashMap<LinearProbingCollisionPolicy> linearMap(0);
+        const double linearDuration = getMilliseconds([&]() {
+            linearMap.Reserve(elementsCount);
+            for (const auto& [key, value] : elements) {
+                linearMap.Emplace(key, value);
+            }
+        });
+
+        HashMap<RobinHoodCollisionPolicy> robinHoodMap(0);
+        const double robinHoodDuration = getMilliseconds([&]() {
+            robinHoodMap.Reserve(elementsCount);
+            for (const auto& [key, value] : elements) {
+                robinHoodMap.Emplace(key, value);
+            }
+        });
+
+        std::optional<BucketsMap> bucketsMap;
+        const double bucketsDuration = getMilliseconds([&]() {
+            bucketsMap.emplace(elementsCount);
+            for (const auto& [key, value] : elements) {
+                bucketsMap->Emplace(key, value);
+            }
+        });
+
+        const auto [perfectFind, perfectFound] = getLookupNanoseconds(hitKeys, [&](Key key) { return perfectMap->Find(key); });
+        const auto [perfectBatchedFind, perfectBatchedFound] = getBatchedLookupNanoseconds(hitKeys, *perfectMap);
+        const auto [linearFind, linearFound] = getLookupNanoseconds(hitKeys, [&](Key key) { return linearMap.Find(key); });
+        const auto [robinHoodFind, robinHoodFound] = getLookupNanoseconds(hitKeys, [&](Key key) { return robinHoodMap.Find(key); });
+        const auto [bucketsFind, bucketsFound] = getLookupNanoseconds(hitKeys, [&](Key key) { return bucketsMap->Find(key); });
+        const auto [perfectMiss, perfectMissFound] = getLookupNanoseconds(missKeys, [&](Key key) { return perfectMap->Find(key); });
+        const auto [linearMiss, linearMissFound] = getLookupNanoseconds(missKeys, [&](Key key) { return linearMap.Find(key); });
+        const auto [robinHoodMiss, robinHoodMissFound] = getLookupNanoseconds(missKeys, [&](Key key) { return robinHoodMap.Find(key); });
+        const auto [bucketsMiss, bucketsMissFound] = getLookupNanoseconds(missKeys, [&](Key key) { return bucketsMap->Find(key); });
+
+        if (perfectFound != lookupsCount || perfectBatchedFound != lookupsCount || linearFound != lookupsCount || robinHoodFound != lookupsCount || bucketsFound != lookupsCount) {
+            throw std::runtime_error("Element not in map bug it must be there");
+        }
+        if (perfectMissFound != 0 || linearMissFound != 0 || robinHoodMissFound != 0 || bucketsMissFound != 0) {
+            throw std::runtime_error("Element in map but it must not be there");
+        }
+
+        if constexpr (validateHashMap) {
+            for (const auto& [key, value] : elements) {
+                const Value* pValue = perfectMap->Find(key);
+                if (!pValue || *pValue != value) {
+                    throw std::runtime_error("Perfect map returned wrong value");
+                }
+            }
+        }
+
+        println(elementsCount, split, perfectMap->GetBitsPerKey(),
+            split, perfectSingleThreadDuration, split, perfectDuration, split, linearDuration, split, robinHoodDuration, split, bucketsDuration,
+            split, perfectFind, split, perfectBatchedFind, split, linearFind, split, robinHoodFind, split, bucketsFind,
+            split, perfectMiss, split, linearMiss, split, robinHoodMiss, split, bucketsMiss);
+    }
+}
+
+int main(int argc, char** argv) {
     try
     {
-        Main();
+        // Multi-threaded benchmark is a separate mode: it takes much longer
+        if (argc > 1 && std::string_view(argv[1]) == "--concurrent") {
+            ConcurrentMain();
+        }
+        else if (argc > 1 && std::string_view(argv[1]) == "--hash-quality") {
+            HashQualityMain();
+        }
+        else if (argc > 1 && std::string_view(argv[1]) == "--mapped") {
+            MappedMain();
+        }
+        else if (argc > 1 && std::string_view(argv[1]) == "--perfect") {
+            PerfectMain();
+        }
+        else {
+            Main();
+        }
     }
     catch (const std::exception& ex) {
         std::cout << "Exception :" << ex.what() << std::endl;
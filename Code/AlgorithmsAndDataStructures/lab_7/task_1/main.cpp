@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <chrono>
 #include <climits>
 #include <fstream>
@@ -10,6 +11,7 @@
 #include "BinaryTree/RedBlackTree.h"
 #include "BinaryTree/PrintTree.h"
 #include "SystemTimer.h"
+#include "workload_lib/WorkloadGenerator.h"
 
 class Multistream
 {
@@ -40,24 +42,21 @@ constexpr bool validateTree = true;
 constexpr bool validateTree = false;
 #endif
 
+// Unique values are a seeded permutation of the distribution range, so they come in random order
 template<typename T, typename Generator, typename Distribution>
 void GenerateRandomVector(std::vector<T>& values, size_t valuesCount, bool unique, bool sorted, Generator&& gen, Distribution& distr) {
-    values.clear();
-    values.reserve(valuesCount);
-    for (size_t i = 0; i < valuesCount; ++i) {
-        auto it = values.begin();
-        T newValue;
-        do
-        {
-            newValue = distr(gen);
-            it = std::lower_bound(values.begin(), values.end(), newValue);
-        } while (!unique || !(it == values.end() || *it != newValue));
-
-        values.insert(it, newValue);
+    if (unique) {
+        Workload::GenerateUniqueKeys(values, valuesCount, distr.a(), distr.b(), gen());
+    }
+    else {
+        values.resize(valuesCount);
+        std::generate(values.begin(), values.end(), [&]() {
+            return distr(gen);
+        });
     }
 
-    if (!sorted) {
-        std::shuffle(values.begin(), values.end(), gen);
+    if (sorted) {
+        std::sort(values.begin(), values.end());
     }
 }
 
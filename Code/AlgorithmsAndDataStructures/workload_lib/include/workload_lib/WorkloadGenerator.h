@@ -0,0 +1,349 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Key sets and lookup sequences for the benchmarks. Every generator is a pure function of its seed:
+// elements are produced by chunks of fixed size, each chunk from its own seed, so the output
+// does not depend on the threads count.
+
+namespace Workload
+{
+    /// splitmix64 finalizer: a bijection of 64 bit values with every output bit depending on every input bit
+    inline uint64_t Mix64(uint64_t value) {
+        value ^= value >> 30;
+        value *= 0xBF58476D1CE4E5B9ull;
+        value ^= value >> 27;
+        value *= 0x94D049BB133111EBull;
+        value ^= value >> 31;
+        return value;
+    }
+
+    /// splitmix64 generator: small state, so each chunk of a parallel generation gets its own
+    class SplitMix64
+    {
+    public:
+        using result_type = uint64_t;
+
+        explicit SplitMix64(uint64_t seed) :
+            m_state(seed)
+        {}
+
+        static constexpr result_type min() {
+            return 0;
+        }
+
+        static constexpr result_type max() {
+            return std::numeric_limits<result_type>::max();
+        }
+
+        result_type operator()() {
+            m_state += 0x9E3779B97F4A7C15ull;
+            return Mix64(m_state);
+        }
+
+        /// Uniform in [0, 1)
+        double NextDouble() {
+            return static_cast<double>((*this)() >> 11) * 0x1.0p-53;
+        }
+
+    private:
+        uint64_t m_state;
+    };
+
+    /// Pseudo random permutation of [0, domainSize) keyed by seed: 4 round Feistel network over
+    /// the smallest even bit width covering the domain. Results out of the domain are encrypted again
+    /// (cycle walking), which keeps the bijection; the width is under 4 * domainSize, so it takes < 4 encryptions on average.
+    /// Zero domain size stands for the whole 64 bit range
+    class FeistelPermutation
+    {
+    private:
+        static constexpr size_t RoundsCount = 4;
+
+    public:
+        FeistelPermutation(uint64_t domainSize, uint64_t seed) :
+            m_domainSize(domainSize)
+        {
+            size_t bits = 64;
+            if (domainSize != 0) {
+                bits = 0;
+                while (bits < 64 && (domainSize - 1) >> bits != 0) {
+                    ++bits;
+                }
+            }
+            m_halfBits = std::max<size_t>(1, (bits + 1) / 2);
+            m_halfMask = (uint64_t{ 1 } << m_halfBits) - 1;
+
+            SplitMix64 keys(seed);
+            for (uint64_t& key : m_roundKeys) {
+                key = keys();
+            }
+        }
+
+        uint64_t operator()(uint64_t index) const {
+            uint64_t value = Encrypt(index);
+            while (m_domainSize != 0 && value >= m_domainSize) {
+                value = Encrypt(value);
+            }
+            return value;
+        }
+
+        uint64_t GetDomainSize() const {
+            return m_domainSize;
+        }
+
+    private:
+        uint64_t Encrypt(uint64_t value) const {
+            uint64_t left = value >> m_halfBits;
+            uint64_t right = value & m_halfMask;
+            for (uint64_t key : m_roundKeys) {
+                const uint64_t next = left ^ (Mix64(right ^ key) & m_halfMask);
+                left = right;
+                right = next;
+            }
+            return (left << m_halfBits) | right;
+        }
+
+    private:
+        uint64_t m_domainSize;
+        size_t m_halfBits;
+        uint64_t m_halfMask;
+        uint64_t m_roundKeys[RoundsCount];
+    };
+
+    /// Zipf distribution over ranks [0, elementsCount): rank k is drawn with probability proportional
+    /// to 1 / (k + 1)^exponent. Rejection-inversion sampling (Hörmann and Derflinger), O(1) per sample
+    /// and no tables, so it suits any elements count
+    class ZipfDistribution
+    {
+    public:
+        ZipfDistribution(uint64_t elementsCount, double exponent) :
+            m_elementsCount(elementsCount),
+            m_exponent(exponent)
+        {
+            if (elementsCount == 0 || !(exponent > 0.)) {
+                throw std::runtime_error("Zipf distribution needs elements and positive exponent");
+            }
+
+            m_hIntegralX1 = HIntegral(1.5) - 1.;
+            m_hIntegralElementsCount = HIntegral(static_cast<double>(elementsCount) + 0.5);
+            m_s = 2. - HIntegralInverse(HIntegral(2.5) - H(2.));
+        }
+
+        uint64_t operator()(SplitMix64& generator) const {
+            while (true) {
+                const double u = m_hIntegralElementsCount + generator.NextDouble() * (m_hIntegralX1 - m_hIntegralElementsCount);
+                const double x = HIntegralInverse(u);
+                const double kReal = std::clamp(std::floor(x + 0.5), 1., static_cast<double>(m_elementsCount));
+                const uint64_t k = static_cast<uint64_t>(kReal);
+                if (kReal - x <= m_s || u >= HIntegral(kReal + 0.5) - H(kReal)) {
+                    return k - 1;
+                }
+            }
+        }
+
+    private:
+        // Integral of H from 1 to x plus a constant, with log(x) / (1 - exponent) kept finite at exponent 1
+        double HIntegral(double x) const {
+            const double logX = std::log(x);
+            return Helper2((1. - m_exponent) * logX) * logX;
+        }
+
+        double H(double x) const {
+            return std::exp(-m_exponent * std::log(x));
+        }
+
+        double HIntegralInverse(double x) const {
+            const double t = std::max(-1., x * (1. - m_exponent));
+            return std::exp(Helper1(t) * x);
+        }
+
+        // log(1 + x) / x
+        static double Helper1(double x) {
+            return std::abs(x) > 1e-8 ? std::log1p(x) / x : 1. - x * (0.5 - x * (1. / 3. - 0.25 * x));
+        }
+
+        // (exp(x) - 1) / x
+        static double Helper2(double x) {
+            return std::abs(x) > 1e-8 ? std::expm1(x) / x : 1. + x * 0.5 * (1. + x / 3. * (1. + 0.25 * x));
+        }
+
+    private:
+        uint64_t m_elementsCount;
+        double m_exponent;
+        double m_hIntegralX1;
+        double m_hIntegralElementsCount;
+        double m_s;
+    };
+}
+
+namespace Workload::detail
+{
+    constexpr size_t ChunkSize = 1 << 16;
+
+    // Key type of range arguments is taken from the keys vector only, so literals of other types convert
+    template<typename Key>
+    struct KeyOfVector
+    {
+        using Type = Key;
+    };
+
+    template<typename Key>
+    constexpr void CheckKeyType() {
+        static_assert(std::is_integral_v<Key> && std::is_unsigned_v<Key> && sizeof(Key) <= sizeof(uint64_t),
+            "Keys are unsigned integers of at most 64 bits");
+    }
+
+    // Number of values in [min, max], zero for the whole 64 bit range
+    inline uint64_t GetRangeSize(uint64_t min, uint64_t max) {
+        if (min > max) {
+            throw std::runtime_error("Key range is empty");
+        }
+        return max - min + 1;
+    }
+
+    inline uint64_t GetChunkSeed(uint64_t seed, size_t chunk) {
+        return Mix64(seed ^ Mix64(static_cast<uint64_t>(chunk)));
+    }
+
+    // Calls fn(begin, end, chunk) for chunks of [0, count), chunks are spread over the threads round robin
+    template<typename Fn>
+    void ForEachChunk(size_t count, size_t threadsCount, const Fn& fn) {
+        const size_t chunksCount = (count + ChunkSize - 1) / ChunkSize;
+        if (threadsCount == 0) {
+            threadsCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+        threadsCount = std::min(threadsCount, chunksCount);
+
+        auto runThread = [&](size_t thread) {
+            for (size_t chunk = thread; chunk < chunksCount; chunk += threadsCount) {
+                fn(chunk * ChunkSize, std::min(count, (chunk + 1) * ChunkSize), chunk);
+            }
+        };
+
+        if (threadsCount <= 1) {
+            runThread(0);
+            return;
+        }
+
+        std::vector<std::thread> threads;
+        threads.reserve(threadsCount - 1);
+        for (size_t thread = 1; thread < threadsCount; ++thread) {
+            threads.emplace_back(runThread, thread);
+        }
+        runThread(0);
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+}
+
+namespace Workload
+{
+    template<typename Key>
+    using KeyOf = typename detail::KeyOfVector<Key>::Type;
+
+    /// 'count' distinct keys of [min, max] in random order: a seeded permutation of the range applied
+    /// to 0, 1, ... count - 1, so uniqueness needs no checks. Throws std::runtime_error if the range is too small
+    template<typename Key>
+    void GenerateUniqueKeys(std::vector<Key>& keys, size_t count, KeyOf<Key> min, KeyOf<Key> max, uint64_t seed,
+        size_t threadsCount = 0)
+    {
+        detail::CheckKeyType<Key>();
+        const uint64_t rangeSize = detail::GetRangeSize(min, max);
+        if (rangeSize != 0 && count > rangeSize) {
+            throw std::runtime_error("Key range is smaller than the unique keys count");
+        }
+
+        const FeistelPermutation permutation(rangeSize, seed);
+        keys.resize(count);
+        detail::ForEachChunk(count, threadsCount, [&](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; ++i) {
+                keys[i] = static_cast<Key>(min + permutation(i));
+            }
+        });
+    }
+
+    /// first, first + step, first + 2 * step, ...
+    template<typename Key>
+    void GenerateSequentialKeys(std::vector<Key>& keys, size_t count, KeyOf<Key> first, KeyOf<Key> step = 1) {
+        detail::CheckKeyType<Key>();
+        keys.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            keys[i] = static_cast<Key>(first + i * step);
+        }
+    }
+
+    /// 'count' distinct keys of [min, max] in runs of 'clusterSize' consecutive values.
+    /// Runs start at distinct random multiples of 'clusterSize' from min and follow in random order
+    template<typename Key>
+    void GenerateClusteredKeys(std::vector<Key>& keys, size_t count, size_t clusterSize, KeyOf<Key> min, KeyOf<Key> max, uint64_t seed,
+        size_t threadsCount = 0)
+    {
+        detail::CheckKeyType<Key>();
+        if (clusterSize == 0) {
+            throw std::runtime_error("Cluster size must be positive");
+        }
+
+        const uint64_t rangeSize = detail::GetRangeSize(min, max);
+        const uint64_t clustersInRange = rangeSize != 0 ?
+            rangeSize / clusterSize :
+            std::numeric_limits<uint64_t>::max() / clusterSize + (std::numeric_limits<uint64_t>::max() % clusterSize + 1) / clusterSize;
+        const size_t clustersCount = (count + clusterSize - 1) / clusterSize;
+        // Zero clusters count stands for 2^64 clusters of size 1
+        if (clustersInRange != 0 && clustersCount > clustersInRange) {
+            throw std::runtime_error("Key range is smaller than the clustered keys count");
+        }
+
+        const FeistelPermutation permutation(clustersInRange, seed);
+        keys.resize(count);
+        detail::ForEachChunk(count, threadsCount, [&](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; ++i) {
+                const uint64_t cluster = permutation(i / clusterSize);
+                keys[i] = static_cast<Key>(min + cluster * clusterSize + i % clusterSize);
+            }
+        });
+    }
+
+    /// 'count' lookups of 'keys' with Zipf distributed popularity: keys[0] is the most popular one.
+    /// Unique keys come in random order, so popular keys are spread over the key range
+    template<typename Key>
+    void GenerateZipfLookups(std::vector<Key>& lookups, const std::vector<Key>& keys, size_t count, double exponent,
+        uint64_t seed, size_t threadsCount = 0)
+    {
+        const ZipfDistribution distribution(keys.size(), exponent);
+        lookups.resize(count);
+        detail::ForEachChunk(count, threadsCount, [&](size_t begin, size_t end, size_t chunk) {
+            SplitMix64 generator(detail::GetChunkSeed(seed, chunk));
+            for (size_t i = begin; i < end; ++i) {
+                lookups[i] = keys[distribution(generator)];
+            }
+        });
+    }
+
+    /// 'count' lookups of 'keys' with uniformly distributed indices
+    template<typename Key>
+    void GenerateUniformLookups(std::vector<Key>& lookups, const std::vector<Key>& keys, size_t count, uint64_t seed,
+        size_t threadsCount = 0)
+    {
+        if (keys.empty()) {
+            throw std::runtime_error("No keys to look up");
+        }
+
+        lookups.resize(count);
+        detail::ForEachChunk(count, threadsCount, [&](size_t begin, size_t end, size_t chunk) {
+            SplitMix64 generator(detail::GetChunkSeed(seed, chunk));
+            for (size_t i = begin; i < end; ++i) {
+                // Modulo bias is below keys.size() / 2^64
+                lookups[i] = keys[static_cast<size_t>(generator() % keys.size())];
+            }
+        });
+    }
+}